@@ -0,0 +1,341 @@
+//*******************************************************************************************************************
+//**  AsyncLogger.h - Shared Low-Overhead Asynchronous Logger (header-only)
+//**  Levels below MYLIB_LOG_LEVEL compile to nothing; enabled levels format into a per-thread lock-free ring
+//**  A background thread drains every ring to stdout, so logging threads never flush and only lock to wake it
+//********************************************************************************************************************
+
+#pragma once
+#ifndef ASYNCLOGGER_H
+#define ASYNCLOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+// ============================================================================
+// Compile-time level filtering
+// ============================================================================
+// Define MYLIB_LOG_LEVEL before including this header (or in the project settings) to change the threshold
+// Default: everything in Debug builds, INFO and above in Release builds
+
+#define MYLIB_LOG_LEVEL_DEBUG 0
+#define MYLIB_LOG_LEVEL_INFO  1
+#define MYLIB_LOG_LEVEL_WARN  2
+#define MYLIB_LOG_LEVEL_ERROR 3
+#define MYLIB_LOG_LEVEL_OFF   4
+
+#ifndef MYLIB_LOG_LEVEL
+#ifdef _DEBUG
+#define MYLIB_LOG_LEVEL MYLIB_LOG_LEVEL_DEBUG
+#else
+#define MYLIB_LOG_LEVEL MYLIB_LOG_LEVEL_INFO
+#endif
+#endif
+
+// printf-style: MYLIB_LOG_WARN("[MyLibrary] Warning: %s", text); arguments of disabled levels are never evaluated
+#if MYLIB_LOG_LEVEL <= MYLIB_LOG_LEVEL_DEBUG
+#define MYLIB_LOG_DEBUG(...) AsyncLogger::Instance().Log(MYLIB_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define MYLIB_LOG_DEBUG(...) ((void)0)
+#endif
+
+#if MYLIB_LOG_LEVEL <= MYLIB_LOG_LEVEL_INFO
+#define MYLIB_LOG_INFO(...) AsyncLogger::Instance().Log(MYLIB_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define MYLIB_LOG_INFO(...) ((void)0)
+#endif
+
+#if MYLIB_LOG_LEVEL <= MYLIB_LOG_LEVEL_WARN
+#define MYLIB_LOG_WARN(...) AsyncLogger::Instance().Log(MYLIB_LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define MYLIB_LOG_WARN(...) ((void)0)
+#endif
+
+#if MYLIB_LOG_LEVEL <= MYLIB_LOG_LEVEL_ERROR
+#define MYLIB_LOG_ERROR(...) AsyncLogger::Instance().Log(MYLIB_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define MYLIB_LOG_ERROR(...) ((void)0)
+#endif
+
+// ============================================================================
+// AsyncLogger
+// ============================================================================
+// One instance per module (each DLL compiles its own copy of Instance())
+// Each logging thread owns a single-producer/single-consumer ring; a full ring drops the message and counts it
+// instead of blocking. Messages keep their order per thread; lines from different threads may interleave.
+// The drainer sleeps until the first record after its last pass; only that record takes the wake lock.
+
+class AsyncLogger
+{
+public:
+    static const unsigned kRingCapacity = 1024;  // Records per thread, power of two
+    static const int kMessageSize = 120;          // Longer messages are truncated
+    static const int kShutdownWaitMs = 1000;      // Longest wait for the drainer to stop
+    static const int kCacheLineSize = 64;
+
+    static AsyncLogger& Instance()
+    {
+        // Never deleted: the drain thread may still be running while static destructors execute
+        static AsyncLogger* instance = new AsyncLogger();
+        static ShutdownGuard guard(instance);
+        return *instance;
+    }
+
+    // The level only selects the macro at compile time; lines are written exactly as formatted
+    void Log(int /*level*/, const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        Ring* ring = m_shutdown.load(std::memory_order_acquire) ? nullptr : GetThreadRing();
+        if (ring == nullptr)
+        {
+            // After the exit flush there is no drainer, and after thread exit no ring; write directly
+            char text[kMessageSize];
+            vsnprintf(text, sizeof(text), format, args);
+            fprintf(stdout, "%s\n", text);
+            fflush(stdout);
+        }
+        else
+        {
+            unsigned tail = ring->tail.load(std::memory_order_relaxed);
+            unsigned used = tail - ring->head.load(std::memory_order_acquire);
+            if (used >= kRingCapacity)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                vsnprintf(ring->records[tail & (kRingCapacity - 1)].text, kMessageSize, format, args);
+                ring->tail.store(tail + 1, std::memory_order_release);
+                WakeDrainer();
+            }
+        }
+        va_end(args);
+    }
+
+    // Writes everything logged so far on the calling thread
+    void Flush()
+    {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        DrainRings();
+    }
+
+    unsigned long long GetDroppedCount() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Record
+    {
+        char text[kMessageSize];
+    };
+
+    // head and tail get a cache line each, so a Log and a drain pass do not bounce one line between their cores
+    struct Ring
+    {
+        Record records[kRingCapacity];
+        alignas(kCacheLineSize) std::atomic<unsigned> head;   // Next record to drain, written by the drainer only
+        alignas(kCacheLineSize) std::atomic<unsigned> tail;   // Next record to fill, written by the owning thread only
+        std::atomic<bool> retired;      // Owning thread exited; freed by the drainer once empty
+
+        Ring() : head(0), tail(0), retired(false) {}
+    };
+
+    // Marks the calling thread's ring as retired when the thread exits
+    // The drainer then frees it, so messages logged later on the way out (from other thread_local destructors)
+    // must not reach it; they go to the direct-write path instead
+    struct ThreadRing
+    {
+        Ring* ring;
+        bool exited;
+
+        ThreadRing() : ring(nullptr), exited(false) {}
+        ~ThreadRing()
+        {
+            if (ring != nullptr)
+                ring->retired.store(true, std::memory_order_release);
+            ring = nullptr;
+            exited = true;
+        }
+    };
+
+    // Runs during static destruction (process exit or DLL unload): stops the drainer and flushes what is left
+    struct ShutdownGuard
+    {
+        AsyncLogger* logger;
+
+        explicit ShutdownGuard(AsyncLogger* owner) : logger(owner) {}
+        ~ShutdownGuard() { logger->Shutdown(); }
+    };
+
+    AsyncLogger() : m_dropped(0), m_pending(false), m_stopRequested(false), m_drainerExited(false), m_shutdown(false)
+    {
+        m_drainer = std::thread(&AsyncLogger::DrainLoop, this);
+    }
+
+    // nullptr once the calling thread is exiting
+    Ring* GetThreadRing()
+    {
+        static thread_local ThreadRing threadRing;
+        if (threadRing.exited)
+            return nullptr;
+        if (threadRing.ring == nullptr)
+        {
+            Ring* ring = new Ring();
+            std::lock_guard<std::mutex> lock(m_registryMutex);
+            m_rings.push_back(ring);
+            threadRing.ring = ring;
+        }
+        return threadRing.ring;
+    }
+
+    // Only the record that sets m_pending notifies. The empty lock keeps the notify from landing between the
+    // drainer's predicate check and its wait, where it would be lost
+    void WakeDrainer()
+    {
+        if (!m_pending.exchange(true, std::memory_order_acq_rel))
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMutex);
+            }
+            m_wake.notify_one();
+        }
+    }
+
+    void DrainLoop()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> wakeLock(m_wakeMutex);
+                m_wake.wait(wakeLock, [this]() {
+                    return m_pending.load(std::memory_order_acquire) || m_stopRequested.load(std::memory_order_acquire);
+                });
+            }
+            if (m_stopRequested.load(std::memory_order_acquire))
+                break;
+
+            // Cleared before the pass and acquired from the producer that set it, so a record published after this
+            // point either is seen by this pass or sets m_pending again
+            m_pending.exchange(false, std::memory_order_acq_rel);
+            std::lock_guard<std::mutex> lock(m_drainMutex);
+            DrainRings();
+        }
+        m_drainerExited.store(true, std::memory_order_release);
+    }
+
+    // At process exit Windows has already terminated the drainer, so there is no acknowledgement to wait for
+    bool IsDrainerAlive()
+    {
+#ifdef _WIN32
+        return WaitForSingleObject(m_drainer.native_handle(), 0) == WAIT_TIMEOUT;
+#else
+        return true;
+#endif
+    }
+
+    // Caller holds m_drainMutex; output is batched into one write per pass
+    void DrainRings()
+    {
+        std::string output;
+        {
+            std::lock_guard<std::mutex> lock(m_registryMutex);
+            size_t kept = 0;
+            for (size_t i = 0; i < m_rings.size(); i++)
+            {
+                Ring* ring = m_rings[i];
+                bool retired = ring->retired.load(std::memory_order_acquire);
+                unsigned head = ring->head.load(std::memory_order_relaxed);
+                unsigned tail = ring->tail.load(std::memory_order_acquire);
+                for (; head != tail; head++)
+                {
+                    output += ring->records[head & (kRingCapacity - 1)].text;
+                    output += '\n';
+                }
+                ring->head.store(head, std::memory_order_release);
+
+                if (retired)
+                    delete ring;
+                else
+                    m_rings[kept++] = ring;
+            }
+            m_rings.resize(kept);
+        }
+
+        if (!output.empty())
+        {
+            fwrite(output.data(), 1, output.size(), stdout);
+            fflush(stdout);
+        }
+    }
+
+    // The drainer acknowledges the stop through m_drainerExited, so on DLL unload it has left the logger before
+    // the module goes away; the wait is bounded in case it never answers. It is then detached, not joined: joining
+    // inside DLL_PROCESS_DETACH deadlocks on the loader lock, which a thread needs to exit. The drain lock is only
+    // tried for a bounded time because a terminated drainer may have died holding it; in that case the remaining
+    // records are dropped.
+    void Shutdown()
+    {
+        m_shutdown.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_stopRequested.store(true, std::memory_order_release);
+        }
+        m_wake.notify_all();
+        if (m_drainer.joinable())
+        {
+            for (int waitedMs = 0; waitedMs < kShutdownWaitMs && IsDrainerAlive(); waitedMs++)
+            {
+                if (m_drainerExited.load(std::memory_order_acquire))
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            m_drainer.detach();
+        }
+
+        std::unique_lock<std::mutex> lock(m_drainMutex, std::defer_lock);
+        for (int attempt = 0; attempt < 1000; attempt++)
+        {
+            if (lock.try_lock())
+            {
+                DrainRings();
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    std::vector<Ring*> m_rings;
+    std::mutex m_registryMutex;
+    std::mutex m_drainMutex;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::thread m_drainer;
+    std::atomic<unsigned long long> m_dropped;
+    std::atomic<bool> m_pending;          // Records were published since the drainer's last pass
+    std::atomic<bool> m_stopRequested;
+    std::atomic<bool> m_drainerExited;    // Set by the drainer as it leaves DrainLoop
+    std::atomic<bool> m_shutdown;
+
+    AsyncLogger(const AsyncLogger&);
+    AsyncLogger& operator=(const AsyncLogger&);
+};
+
+#endif // ASYNCLOGGER_H
@@ -0,0 +1,136 @@
+//*******************************************************************************************************************
+//**  CpuFeatures.h - Shared Runtime CPU Feature Detection (header-only)
+//**  Used by both DLLs to select SIMD kernels at runtime from CPUID
+//********************************************************************************************************************
+
+#pragma once
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MYLIB_X86 1
+#endif
+
+#ifdef MYLIB_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+// MSVC accepts any intrinsic in any function, GCC/Clang need the target ISA enabled per function
+#if defined(MYLIB_X86) && !defined(_MSC_VER)
+#define MYLIB_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define MYLIB_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+#else
+#define MYLIB_TARGET_SSE42
+#define MYLIB_TARGET_AVX2
+#endif
+
+// Kernel level chosen by the dispatchers, ordered from slowest to fastest
+enum class SimdLevel
+{
+    Scalar = 0,
+    SSE2 = 1,
+    AVX2 = 2
+};
+
+struct CpuFeatures
+{
+    bool sse2;
+    bool ssse3;
+    bool sse41;
+    bool sse42;
+    bool popcnt;
+    bool avx2;
+    bool bmi2;
+};
+
+inline CpuFeatures DetectCpuFeatures()
+{
+    CpuFeatures features = {};
+#ifdef MYLIB_X86
+    unsigned int regs[4] = {};
+    unsigned int maxLeaf = 0;
+
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    maxLeaf = static_cast<unsigned int>(info[0]);
+    __cpuid(info, 1);
+    for (int i = 0; i < 4; i++)
+        regs[i] = static_cast<unsigned int>(info[i]);
+#else
+    maxLeaf = __get_cpuid_max(0, nullptr);
+    __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+    features.sse2 = (regs[3] & (1u << 26)) != 0;
+    features.ssse3 = (regs[2] & (1u << 9)) != 0;
+    features.sse41 = (regs[2] & (1u << 19)) != 0;
+    features.sse42 = (regs[2] & (1u << 20)) != 0;
+    features.popcnt = (regs[2] & (1u << 23)) != 0;
+
+    // AVX2 also needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+    bool osSavesYmm = false;
+    if ((regs[2] & (1u << 27)) != 0 && (regs[2] & (1u << 28)) != 0)
+    {
+#if defined(_MSC_VER)
+        unsigned long long xcr0 = _xgetbv(0);
+#else
+        unsigned int eax = 0, edx = 0;
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+        osSavesYmm = (xcr0 & 0x6) == 0x6;
+    }
+
+    if (maxLeaf >= 7 && osSavesYmm)
+    {
+#if defined(_MSC_VER)
+        __cpuidex(info, 7, 0);
+        for (int i = 0; i < 4; i++)
+            regs[i] = static_cast<unsigned int>(info[i]);
+#else
+        __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        features.avx2 = (regs[1] & (1u << 5)) != 0;
+        features.bmi2 = (regs[1] & (1u << 8)) != 0;
+    }
+#endif
+    return features;
+}
+
+// Detected once per module and cached
+inline const CpuFeatures& GetCpuFeatures()
+{
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+inline SimdLevel GetSimdLevel()
+{
+    const CpuFeatures& features = GetCpuFeatures();
+    if (features.avx2 && features.popcnt)
+        return SimdLevel::AVX2;
+    if (features.sse2)
+        return SimdLevel::SSE2;
+    return SimdLevel::Scalar;
+}
+
+inline const char* GetSimdLevelString(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::SSE2:
+        return "SSE2";
+    default:
+        return "Scalar";
+    }
+}
+
+#endif // CPUFEATURES_H
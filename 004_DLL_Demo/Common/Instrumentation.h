@@ -0,0 +1,276 @@
+//*******************************************************************************************************************
+//**  Instrumentation.h - Shared Per-Function Call Counters and Latency Histograms (header-only)
+//**  InstrumentationRecord is the C-compatible snapshot type returned by the DLL exports
+//**  Each DLL defines a tag with its function names and wraps exported functions in MYLIB_INSTRUMENT_SCOPE
+//********************************************************************************************************************
+
+#pragma once
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// Latency histogram layout (HDR-style): 4 linear sub-buckets per power of two of nanoseconds
+// Buckets 0-3 hold 0-3 ns exactly; bucket 4 * (k - 1) + s holds [(4 + s) << (k - 2), (5 + s) << (k - 2)) for k >= 2
+// The last bucket also collects everything above ~8.6 s
+#define MYLIB_INSTRUMENTATION_BUCKETS 128
+
+// Snapshot of one instrumented function, summed over every thread that called it
+struct InstrumentationRecord
+{
+    const char* name;                      // Static string owned by the DLL
+    unsigned long long callCount;
+    unsigned long long totalNanoseconds;
+    unsigned long long maxNanoseconds;
+    unsigned long long histogram[MYLIB_INSTRUMENTATION_BUCKETS];
+};
+
+// Compile-time switch: define MYLIB_INSTRUMENTATION=0 to remove every timing scope from the build
+// With it compiled in, a disabled runtime flag costs one relaxed load and a branch per call
+#ifndef MYLIB_INSTRUMENTATION
+#define MYLIB_INSTRUMENTATION 1
+#endif
+
+#if MYLIB_INSTRUMENTATION
+#define MYLIB_INSTRUMENT_SCOPE(Tag, function) MyLib::Instrumentation::Scope<Tag> instrumentationScope(function)
+#else
+#define MYLIB_INSTRUMENT_SCOPE(Tag, function) ((void)0)
+#endif
+
+namespace MyLib
+{
+    namespace Instrumentation
+    {
+        inline int GetBucketIndex(unsigned long long nanoseconds)
+        {
+            if (nanoseconds < 4)
+                return static_cast<int>(nanoseconds);
+            int log2 = 0;
+            for (int step = 32; step > 0; step >>= 1)
+            {
+                if ((nanoseconds >> (log2 + step)) != 0)
+                    log2 += step;
+            }
+            int subBucket = static_cast<int>((nanoseconds >> (log2 - 2)) & 3);
+            int bucket = 4 * (log2 - 1) + subBucket;
+            return (bucket < MYLIB_INSTRUMENTATION_BUCKETS) ? bucket : MYLIB_INSTRUMENTATION_BUCKETS - 1;
+        }
+
+        // Smallest latency counted in a bucket, for printing snapshots
+        inline unsigned long long GetBucketLowerBound(int bucket)
+        {
+            if (bucket < 4)
+                return static_cast<unsigned long long>(bucket);
+            int log2 = bucket / 4 + 1;
+            return static_cast<unsigned long long>(4 + bucket % 4) << (log2 - 2);
+        }
+
+        // ============================================================================
+        // Registry<Tag>
+        // ============================================================================
+        // Tag supplies kFunctionCount and GetName(int); one registry (and one flag) exists per tag
+        // Every thread writes only its own block with relaxed load/store pairs, so recording takes no lock
+        // and snapshots can read the blocks concurrently. Blocks of exited threads are folded into m_retired.
+
+        template <typename Tag>
+        class Registry
+        {
+        public:
+            static Registry& Instance()
+            {
+                // Never deleted: thread exit handlers may still fold their blocks in during shutdown
+                static Registry* instance = new Registry();
+                return *instance;
+            }
+
+            static bool IsEnabled()
+            {
+                return s_enabled.load(std::memory_order_relaxed);
+            }
+
+            static void SetEnabled(bool enabled)
+            {
+                s_enabled.store(enabled, std::memory_order_relaxed);
+            }
+
+            void Record(int function, unsigned long long nanoseconds)
+            {
+                GetThreadBlock()->slots[function].Add(nanoseconds);
+            }
+
+            // Fills up to capacity records in function order and returns the number of instrumented functions
+            int Snapshot(InstrumentationRecord* records, int capacity)
+            {
+                const int count = (records == nullptr || capacity < 0) ? 0 : ((capacity < Tag::kFunctionCount) ? capacity : Tag::kFunctionCount);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (int function = 0; function < count; function++)
+                {
+                    InstrumentationRecord& record = records[function];
+                    record.name = Tag::GetName(function);
+                    record.callCount = 0;
+                    record.totalNanoseconds = 0;
+                    record.maxNanoseconds = 0;
+                    for (int bucket = 0; bucket < MYLIB_INSTRUMENTATION_BUCKETS; bucket++)
+                        record.histogram[bucket] = 0;
+
+                    m_retired.slots[function].AddTo(record);
+                    for (size_t i = 0; i < m_blocks.size(); i++)
+                        m_blocks[i]->slots[function].AddTo(record);
+                }
+                return Tag::kFunctionCount;
+            }
+
+        private:
+            // Written by one thread only; the atomics make concurrent snapshot reads well-defined
+            struct Slot
+            {
+                std::atomic<unsigned long long> callCount;
+                std::atomic<unsigned long long> totalNanoseconds;
+                std::atomic<unsigned long long> maxNanoseconds;
+                std::atomic<unsigned long long> histogram[MYLIB_INSTRUMENTATION_BUCKETS];
+
+                Slot() : callCount(0), totalNanoseconds(0), maxNanoseconds(0)
+                {
+                    for (int bucket = 0; bucket < MYLIB_INSTRUMENTATION_BUCKETS; bucket++)
+                        histogram[bucket].store(0, std::memory_order_relaxed);
+                }
+
+                static void Bump(std::atomic<unsigned long long>& counter, unsigned long long delta)
+                {
+                    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+                }
+
+                void Add(unsigned long long nanoseconds)
+                {
+                    Bump(callCount, 1);
+                    Bump(totalNanoseconds, nanoseconds);
+                    Bump(histogram[GetBucketIndex(nanoseconds)], 1);
+                    if (nanoseconds > maxNanoseconds.load(std::memory_order_relaxed))
+                        maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+                }
+
+                // Caller holds the registry mutex (m_retired is updated by several threads)
+                void Merge(const Slot& other)
+                {
+                    Bump(callCount, other.callCount.load(std::memory_order_relaxed));
+                    Bump(totalNanoseconds, other.totalNanoseconds.load(std::memory_order_relaxed));
+                    for (int bucket = 0; bucket < MYLIB_INSTRUMENTATION_BUCKETS; bucket++)
+                        Bump(histogram[bucket], other.histogram[bucket].load(std::memory_order_relaxed));
+                    unsigned long long otherMax = other.maxNanoseconds.load(std::memory_order_relaxed);
+                    if (otherMax > maxNanoseconds.load(std::memory_order_relaxed))
+                        maxNanoseconds.store(otherMax, std::memory_order_relaxed);
+                }
+
+                void AddTo(InstrumentationRecord& record) const
+                {
+                    record.callCount += callCount.load(std::memory_order_relaxed);
+                    record.totalNanoseconds += totalNanoseconds.load(std::memory_order_relaxed);
+                    for (int bucket = 0; bucket < MYLIB_INSTRUMENTATION_BUCKETS; bucket++)
+                        record.histogram[bucket] += histogram[bucket].load(std::memory_order_relaxed);
+                    unsigned long long slotMax = maxNanoseconds.load(std::memory_order_relaxed);
+                    if (slotMax > record.maxNanoseconds)
+                        record.maxNanoseconds = slotMax;
+                }
+            };
+
+            struct ThreadBlock
+            {
+                Slot slots[Tag::kFunctionCount];
+            };
+
+            // Owns the calling thread's block and retires it when the thread exits
+            struct ThreadHolder
+            {
+                ThreadBlock* block;
+
+                ThreadHolder() : block(nullptr) {}
+                ~ThreadHolder()
+                {
+                    if (block != nullptr)
+                        Instance().Retire(block);
+                }
+            };
+
+            Registry() {}
+
+            ThreadBlock* GetThreadBlock()
+            {
+                static thread_local ThreadHolder holder;
+                if (holder.block == nullptr)
+                {
+                    ThreadBlock* block = new ThreadBlock();
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_blocks.push_back(block);
+                    holder.block = block;
+                }
+                return holder.block;
+            }
+
+            void Retire(ThreadBlock* block)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (int function = 0; function < Tag::kFunctionCount; function++)
+                    m_retired.slots[function].Merge(block->slots[function]);
+                for (size_t i = 0; i < m_blocks.size(); i++)
+                {
+                    if (m_blocks[i] == block)
+                    {
+                        m_blocks[i] = m_blocks.back();
+                        m_blocks.pop_back();
+                        break;
+                    }
+                }
+                delete block;
+            }
+
+            static std::atomic<bool> s_enabled;
+
+            std::mutex m_mutex;
+            std::vector<ThreadBlock*> m_blocks;
+            ThreadBlock m_retired;
+
+            Registry(const Registry&);
+            Registry& operator=(const Registry&);
+        };
+
+        template <typename Tag>
+        std::atomic<bool> Registry<Tag>::s_enabled(false);
+
+        // Times the enclosing scope when instrumentation is enabled at construction
+        template <typename Tag>
+        class Scope
+        {
+        public:
+            explicit Scope(int function) : m_function(-1)
+            {
+                if (Registry<Tag>::IsEnabled())
+                {
+                    m_function = function;
+                    m_start = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~Scope()
+            {
+                if (m_function >= 0)
+                {
+                    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - m_start;
+                    long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+                    Registry<Tag>::Instance().Record(m_function, static_cast<unsigned long long>(nanoseconds > 0 ? nanoseconds : 0));
+                }
+            }
+
+        private:
+            int m_function;
+            std::chrono::steady_clock::time_point m_start;
+
+            Scope(const Scope&);
+            Scope& operator=(const Scope&);
+        };
+    }
+}
+
+#endif // INSTRUMENTATION_H
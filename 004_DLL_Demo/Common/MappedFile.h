@@ -0,0 +1,199 @@
+//*******************************************************************************************************************
+//**  MappedFile.h - Shared Windowed Read-Only File Mapping (header-only)
+//**  Maps a large file one window at a time, so resident memory stays bounded by the window size
+//**  Windows: CreateFileMapping/MapViewOfFile, POSIX: mmap with madvise(MADV_SEQUENTIAL)
+//********************************************************************************************************************
+
+#pragma once
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile
+{
+public:
+    MappedFile()
+        : m_size(0), m_view(nullptr), m_viewLength(0)
+#ifdef _WIN32
+        , m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+#else
+        , m_fd(-1)
+#endif
+    {
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    bool Open(const char* path)
+    {
+        Close();
+        if (path == nullptr)
+            return false;
+#ifdef _WIN32
+        m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size))
+        {
+            Close();
+            return false;
+        }
+        m_size = static_cast<unsigned long long>(size.QuadPart);
+        // An empty file cannot be mapped; it is still a valid (empty) input
+        if (m_size > 0)
+        {
+            m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping == nullptr)
+            {
+                Close();
+                return false;
+            }
+        }
+#else
+        m_fd = open(path, O_RDONLY);
+        if (m_fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(m_fd, &info) != 0)
+        {
+            Close();
+            return false;
+        }
+        m_size = static_cast<unsigned long long>(info.st_size);
+#endif
+        return true;
+    }
+
+    void Close()
+    {
+        ReleaseWindow();
+#ifdef _WIN32
+        if (m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+            m_fd = -1;
+        }
+#endif
+        m_size = 0;
+    }
+
+    bool IsOpen() const
+    {
+#ifdef _WIN32
+        return m_file != INVALID_HANDLE_VALUE;
+#else
+        return m_fd >= 0;
+#endif
+    }
+
+    unsigned long long GetSize() const
+    {
+        return m_size;
+    }
+
+    // Offsets passed to MapWindow should be multiples of this to avoid mapping extra leading bytes
+    static size_t GetGranularity()
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwAllocationGranularity);
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    // Maps [offset, offset + length) clipped to the file size and unmaps the previous window
+    // Returns a pointer to the byte at offset, or nullptr on failure or past the end of the file
+    const char* MapWindow(unsigned long long offset, size_t length, size_t* mappedLength)
+    {
+        ReleaseWindow();
+        if (mappedLength != nullptr)
+            *mappedLength = 0;
+        if (!IsOpen() || offset >= m_size || length == 0)
+            return nullptr;
+        if (length > m_size - offset)
+            length = static_cast<size_t>(m_size - offset);
+
+        const unsigned long long granularity = GetGranularity();
+        const unsigned long long alignedOffset = offset - offset % granularity;
+        const size_t lead = static_cast<size_t>(offset - alignedOffset);
+#ifdef _WIN32
+        void* view = MapViewOfFile(m_mapping, FILE_MAP_READ, static_cast<DWORD>(alignedOffset >> 32),
+                                   static_cast<DWORD>(alignedOffset & 0xFFFFFFFFULL), lead + length);
+        if (view == nullptr)
+            return nullptr;
+#else
+        void* view = mmap(nullptr, lead + length, PROT_READ, MAP_SHARED, m_fd, static_cast<off_t>(alignedOffset));
+        if (view == MAP_FAILED)
+            return nullptr;
+        madvise(view, lead + length, MADV_SEQUENTIAL);
+#endif
+        m_view = view;
+        m_viewLength = lead + length;
+        if (mappedLength != nullptr)
+            *mappedLength = length;
+        return static_cast<const char*>(view) + lead;
+    }
+
+    void ReleaseWindow()
+    {
+        if (m_view == nullptr)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(m_view);
+#else
+        munmap(m_view, m_viewLength);
+#endif
+        m_view = nullptr;
+        m_viewLength = 0;
+    }
+
+private:
+    unsigned long long m_size;
+    void* m_view;
+    size_t m_viewLength;
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_fd;
+#endif
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,1167 @@
+//*******************************************************************************************************************
+//**  Benchmarks.cpp - Performance Benchmarks for the DLL Demo
+//**  Compares the new batch/concurrent APIs against the per-call usage they replace
+//********************************************************************************************************************
+
+#include "Benchmarks.h"
+#include <iostream>
+#include <iomanip>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <string>
+#include <vector>
+#include "..\MyLibrary\MyLibrary.h"
+#include "..\MyLibrary002\MyLibrary002.h"
+
+// ============================================================================
+// Timing helpers
+// ============================================================================
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Best of several runs in milliseconds, so a single preemption does not skew the result
+    template <typename Func>
+    double MeasureBestMs(int runs, Func func)
+    {
+        double best = 0.0;
+        for (int run = 0; run < runs; run++)
+        {
+            Clock::time_point start = Clock::now();
+            func();
+            double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (run == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+
+    void PrintRate(const char* label, double ms, double elements)
+    {
+        std::ios::fmtflags flags = std::cout.flags();
+        std::cout << "   " << std::left << std::setw(36) << label << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(10) << ms << " ms  "
+                  << std::setprecision(1) << std::setw(8) << (elements / (ms * 1000.0)) << " M elem/s" << std::endl;
+        std::cout.flags(flags);
+    }
+
+    void PrintSpeedup(const char* label, double baselineMs, double ms)
+    {
+        std::ios::fmtflags flags = std::cout.flags();
+        std::cout << "   Speedup " << label << ": x" << std::fixed << std::setprecision(1) << (baselineMs / ms) << std::endl;
+        std::cout.flags(flags);
+    }
+
+    // Keeps results observable so the optimizer cannot drop the measured loop
+    volatile long long g_sink = 0;
+}
+
+// ============================================================================
+// MyLibrary benchmarks
+// ============================================================================
+
+void RunBatchArithmeticBenchmark()
+{
+    const int count = 1 << 22;
+    const int runs = 5;
+    std::vector<int> a(count), b(count), out(count);
+    for (int i = 0; i < count; i++)
+    {
+        a[i] = i * 7 + 3;
+        b[i] = (i % 1000) - 500;
+    }
+
+    std::cout << "Batch arithmetic (" << count << " int pairs, kernel: " << GetBatchKernelName() << "):" << std::endl;
+
+    double perCallMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < count; i++)
+            out[i] = Add(a[i], b[i]);
+        g_sink = g_sink + out[count - 1];
+    });
+    PrintRate("Add() per-call loop", perCallMs, count);
+
+    double batchMs = MeasureBestMs(runs, [&]() {
+        AddArray(a.data(), b.data(), out.data(), count);
+        g_sink = g_sink + out[count - 1];
+    });
+    PrintRate("AddArray()", batchMs, count);
+
+    double perCallMulMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < count; i++)
+            out[i] = Multiply(a[i], b[i]);
+        g_sink = g_sink + out[count - 1];
+    });
+    PrintRate("Multiply() per-call loop", perCallMulMs, count);
+
+    double batchMulMs = MeasureBestMs(runs, [&]() {
+        MultiplyArray(a.data(), b.data(), out.data(), count);
+        g_sink = g_sink + out[count - 1];
+    });
+    PrintRate("MultiplyArray()", batchMulMs, count);
+
+    std::vector<double> da(count), db(count), dout(count);
+    for (int i = 0; i < count; i++)
+    {
+        da[i] = i * 0.5;
+        db[i] = static_cast<double>(i % 100);
+    }
+    Calculator calc;
+    double perCallDivMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < count; i++)
+            dout[i] = (db[i] == 0.0) ? 0.0 : calc.Divide(da[i], db[i]);
+        g_sink = g_sink + static_cast<long long>(dout[count - 1]);
+    });
+    PrintRate("Calculator::Divide() per-call loop", perCallDivMs, count);
+
+    double batchDivMs = MeasureBestMs(runs, [&]() {
+        DivideArray(da.data(), db.data(), dout.data(), count);
+        g_sink = g_sink + static_cast<long long>(dout[count - 1]);
+    });
+    PrintRate("DivideArray()", batchDivMs, count);
+
+    // Every other divisor zeroed: the masked divide should not slow down on bad data
+    std::vector<double> dbBad(db);
+    for (int i = 0; i < count; i += 2)
+        dbBad[i] = 0.0;
+    int zeroCount = 0;
+    double cleanExMs = MeasureBestMs(runs, [&]() {
+        zeroCount = DivideArrayEx(da.data(), db.data(), dout.data(), count, DIVIDE_BY_ZERO_RETURN_NAN, 0.0, nullptr);
+    });
+    PrintRate("DivideArrayEx() clean data", cleanExMs, count);
+    double badExMs = MeasureBestMs(runs, [&]() {
+        zeroCount = DivideArrayEx(da.data(), dbBad.data(), dout.data(), count, DIVIDE_BY_ZERO_RETURN_NAN, 0.0, nullptr);
+    });
+    PrintRate("DivideArrayEx() 50% zero divisors", badExMs, count);
+    std::cout << "   Zero divisors reported: " << zeroCount << std::endl;
+
+    PrintSpeedup("AddArray", perCallMs, batchMs);
+    PrintSpeedup("MultiplyArray", perCallMulMs, batchMulMs);
+    PrintSpeedup("DivideArray", perCallDivMs, batchDivMs);
+    std::cout << std::endl;
+}
+
+void RunConcurrentAccumulatorBenchmark()
+{
+    const int addsPerThread = 200000;
+    const int threadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    std::cout << "Concurrent accumulation (" << addsPerThread << " adds per thread, "
+              << std::thread::hardware_concurrency() << " hardware threads):" << std::endl;
+
+    for (int threads : threadCounts)
+    {
+        double totalAdds = static_cast<double>(threads) * addsPerThread;
+
+        // Baseline: one Calculator value guarded by a mutex
+        Calculator lockedCalc;
+        std::mutex lock;
+        double mutexMs = MeasureBestMs(3, [&]() {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++)
+            {
+                workers.emplace_back([&]() {
+                    for (int i = 0; i < addsPerThread; i++)
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        lockedCalc.AddToValue(1);
+                    }
+                });
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+        });
+
+        Calculator shardedCalc;
+        shardedCalc.EnableConcurrentMode();
+        double shardedMs = MeasureBestMs(3, [&]() {
+            shardedCalc.SetValue(0);
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++)
+            {
+                workers.emplace_back([&]() {
+                    for (int i = 0; i < addsPerThread; i++)
+                        shardedCalc.AddToValue(1);
+                });
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+        });
+
+        std::string label = std::to_string(threads) + " threads";
+        PrintRate((label + ", mutex").c_str(), mutexMs, totalAdds);
+        PrintRate((label + ", sharded").c_str(), shardedMs, totalAdds);
+        if (shardedCalc.GetValue() != threads * addsPerThread)
+            std::cout << "   ERROR: sharded total " << shardedCalc.GetValue() << " is wrong" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+// The divisor comes from a volatile so the compiler cannot turn the baseline loop into its own multiply-and-shift
+void RunIntegerDivideBenchmark()
+{
+    const int count = 1 << 22;
+    const int runs = 5;
+    volatile int runtimeDivisor = 7;
+    const int divisor = runtimeDivisor;
+    std::vector<int> values(count), out(count);
+    for (int i = 0; i < count; i++)
+        values[i] = i * 37 - 1000000;
+
+    std::cout << "Invariant-divisor division (" << count << " ints / " << divisor << ", kernel: " << GetBatchKernelName() << "):" << std::endl;
+
+    double plainMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < count; i++)
+            out[i] = values[i] / divisor;
+        g_sink = g_sink + out[count - 1];
+    });
+    PrintRate("Plain operator/", plainMs, count);
+
+    MyLib::Divider<int> divider(divisor);
+    double dividerMs = MeasureBestMs(runs, [&]() {
+        divider.DivideArray(values.data(), out.data(), static_cast<size_t>(count));
+        g_sink = g_sink + out[count - 1];
+    });
+    PrintRate("MyLib::Divider<int> (inlined)", dividerMs, count);
+
+    double batchMs = MeasureBestMs(runs, [&]() {
+        DivideArrayByScalar(values.data(), divisor, out.data(), count);
+        g_sink = g_sink + out[count - 1];
+    });
+    PrintRate("DivideArrayByScalar", batchMs, count);
+    PrintSpeedup("Divider vs operator/", plainMs, dividerMs);
+    PrintSpeedup("DivideArrayByScalar vs operator/", plainMs, batchMs);
+
+    bool match = true;
+    for (int i = 0; i < count; i++)
+        match = match && (out[i] == values[i] / divisor);
+    std::cout << "   Results " << (match ? "match operator/" : "ERROR: differ from operator/") << std::endl;
+    std::cout << std::endl;
+}
+
+// elementCount = 1e9 needs 8 GB for the double input; the demo passes a smaller count
+void RunParallelReductionBenchmark(long long elementCount)
+{
+    std::vector<double> data(static_cast<size_t>(elementCount));
+    for (long long i = 0; i < elementCount; i++)
+        data[static_cast<size_t>(i)] = 1.0 / static_cast<double>(i % 1000 + 1);
+
+    int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    if (hardwareThreads <= 0)
+        hardwareThreads = 1;
+
+    std::cout << "Parallel reduction (" << elementCount << " doubles, up to " << hardwareThreads << " threads):" << std::endl;
+
+    double serialSum = 0.0;
+    double serialMs = MeasureBestMs(3, [&]() {
+        double sum = 0.0;
+        for (long long i = 0; i < elementCount; i++)
+            sum += data[static_cast<size_t>(i)];
+        serialSum = sum;
+    });
+    PrintRate("Serial loop", serialMs, static_cast<double>(elementCount));
+
+    double firstSum = 0.0;
+    bool deterministic = true;
+    for (int threads = 1; threads <= hardwareThreads; threads *= 2)
+    {
+        ParallelReducer reducer(threads);
+        double sum = 0.0;
+        double ms = MeasureBestMs(3, [&]() { sum = reducer.Sum(data.data(), elementCount); });
+        std::string label = "ParallelReducer::Sum, " + std::to_string(threads) + " threads";
+        PrintRate(label.c_str(), ms, static_cast<double>(elementCount));
+        if (threads == 1)
+            firstSum = sum;
+        else if (sum != firstSum)
+            deterministic = false;
+        if (threads * 2 > hardwareThreads && threads != hardwareThreads)
+            threads = hardwareThreads / 2;
+    }
+
+    std::ios::fmtflags flags = std::cout.flags();
+    std::cout << "   Serial sum " << std::setprecision(17) << serialSum << ", pairwise sum " << firstSum
+              << (deterministic ? " (bit-identical for every thread count)" : " (ERROR: differs between thread counts)") << std::endl;
+    std::cout.flags(flags);
+    std::cout << std::endl;
+}
+
+// Writes a temporary double file next to the executable and compares load-then-reduce with the mapped stream
+void RunStreamingReducerBenchmark(long long elementCount)
+{
+    const char* path = "stream_benchmark.bin";
+    std::vector<double> data(static_cast<size_t>(elementCount));
+    for (long long i = 0; i < elementCount; i++)
+        data[static_cast<size_t>(i)] = static_cast<double>(i % 1000) * 0.5;
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(double)));
+        if (!file)
+        {
+            std::cout << "Streaming reducer: could not write " << path << std::endl << std::endl;
+            return;
+        }
+    }
+    std::vector<double>().swap(data);
+
+    std::cout << "Streaming reducer (" << elementCount << " doubles, " << (elementCount * 8 >> 20) << " MB file):" << std::endl;
+
+    double loadedSum = 0.0;
+    double loadMs = MeasureBestMs(3, [&]() {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<double> values(static_cast<size_t>(elementCount));
+        file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(double)));
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); i++)
+            sum += values[i];
+        loadedSum = sum;
+    });
+    PrintRate("Read into vector + sum", loadMs, static_cast<double>(elementCount));
+
+    StreamingReducer reducer;
+    StreamStatistics stats = { 0, 0, 0.0, 0.0, 0.0, 0, 0 };
+    double streamMs = MeasureBestMs(3, [&]() { reducer.Reduce(path, NUMERIC_FILE_DOUBLE, &stats); });
+    PrintRate("StreamingReducer::Reduce", streamMs, static_cast<double>(elementCount));
+    PrintSpeedup("streaming vs load", loadMs, streamMs);
+
+    std::ios::fmtflags flags = std::cout.flags();
+    std::cout << "   Window " << (reducer.GetWindowSize() >> 20) << " MB, sums " << std::setprecision(15)
+              << loadedSum << " / " << stats.sum << ", min " << stats.min << ", max " << stats.max << std::endl;
+    std::cout.flags(flags);
+    std::cout << std::endl;
+    std::remove(path);
+}
+
+namespace
+{
+    // Latency at the given quantile, as the lower bound of the histogram bucket that contains it
+    unsigned long long GetQuantileNanoseconds(const InstrumentationRecord& record, double quantile)
+    {
+        unsigned long long target = static_cast<unsigned long long>(quantile * static_cast<double>(record.callCount));
+        unsigned long long seen = 0;
+        for (int bucket = 0; bucket < MYLIB_INSTRUMENTATION_BUCKETS; bucket++)
+        {
+            seen += record.histogram[bucket];
+            if (seen > target)
+                return MyLib::Instrumentation::GetBucketLowerBound(bucket);
+        }
+        return record.maxNanoseconds;
+    }
+
+    void PrintInstrumentationSnapshot(const char* library, const std::vector<InstrumentationRecord>& records)
+    {
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            const InstrumentationRecord& record = records[i];
+            if (record.callCount == 0)
+                continue;
+            std::cout << "   " << library << " " << std::left << std::setw(32) << record.name << std::right
+                      << " calls " << std::setw(8) << record.callCount
+                      << "  p50 " << std::setw(6) << GetQuantileNanoseconds(record, 0.50) << " ns"
+                      << "  p99 " << std::setw(6) << GetQuantileNanoseconds(record, 0.99) << " ns"
+                      << "  max " << record.maxNanoseconds << " ns" << std::endl;
+        }
+    }
+}
+
+// Cost of a tiny export with instrumentation compiled in but disabled, then enabled, followed by a snapshot
+void RunInstrumentationBenchmark()
+{
+    const int count = 1 << 20;
+    const int runs = 3;
+
+    std::cout << "Instrumentation (" << count << " calls to Add):" << std::endl;
+
+    SetInstrumentationEnabled(0);
+    double disabledMs = MeasureBestMs(runs, [&]() {
+        long long sum = 0;
+        for (int i = 0; i < count; i++)
+            sum += Add(i, 1);
+        g_sink = g_sink + sum;
+    });
+    PrintRate("Add, instrumentation disabled", disabledMs, count);
+
+    SetInstrumentationEnabled(1);
+    SetStringInstrumentationEnabled(1);
+    double enabledMs = MeasureBestMs(runs, [&]() {
+        long long sum = 0;
+        for (int i = 0; i < count; i++)
+            sum += Add(i, 1);
+        g_sink = g_sink + sum;
+    });
+    PrintRate("Add, instrumentation enabled", enabledMs, count);
+
+    TextProcessor& processor = GetTextProcessorInstance();
+    for (int i = 0; i < 1000; i++)
+        g_sink = g_sink + processor.CountWords("the quick brown fox jumps over the lazy dog");
+    SetInstrumentationEnabled(0);
+    SetStringInstrumentationEnabled(0);
+
+    std::vector<InstrumentationRecord> records(static_cast<size_t>(GetInstrumentationSnapshot(nullptr, 0)));
+    GetInstrumentationSnapshot(records.data(), static_cast<int>(records.size()));
+    PrintInstrumentationSnapshot("MyLibrary   ", records);
+
+    records.resize(static_cast<size_t>(GetStringInstrumentationSnapshot(nullptr, 0)));
+    GetStringInstrumentationSnapshot(records.data(), static_cast<int>(records.size()));
+    PrintInstrumentationSnapshot("MyLibrary002", records);
+    std::cout << std::endl;
+}
+
+// Constructors/destructors log through the async logger; in Release builds the DEBUG lifetime messages compile out
+void RunObjectLifetimeBenchmark()
+{
+    const int count = 100000;
+    const int runs = 3;
+
+    std::cout << "Object lifetime (" << count << " short-lived objects per type):" << std::endl;
+
+    double calculatorMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < count; i++)
+        {
+            Calculator calc;
+            calc.SetValue(i);
+            g_sink = g_sink + calc.GetValue();
+        }
+    });
+    PrintRate("Calculator create/destroy", calculatorMs, count);
+
+    double stringMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < count; i++)
+        {
+            StringUtility text("lifetime");
+            g_sink = g_sink + text.GetLength();
+        }
+    });
+    PrintRate("StringUtility create/destroy", stringMs, count);
+    std::cout << std::endl;
+}
+
+// ============================================================================
+// MyLibrary002 benchmarks
+// ============================================================================
+
+// Short tags fit the inline buffer, so neither construction nor SetString touches the heap
+void RunSmallStringBenchmark()
+{
+    const int count = 1000000;
+    const int runs = 3;
+    const char* shortTag = "tag-000123";
+    const char* longText = "a string that is clearly longer than the inline buffer";
+
+    std::cout << "StringUtility small-string buffer (" << count << " objects):" << std::endl;
+
+    int heapObjects = 0;
+    double shortMs = MeasureBestMs(runs, [&]() {
+        heapObjects = 0;
+        for (int i = 0; i < count; i++)
+        {
+            StringUtility tag(shortTag);
+            tag.SetString("tag-999");
+            heapObjects += tag.IsInline() ? 0 : 1;
+        }
+    });
+    PrintRate("Construct + SetString, 10 chars", shortMs, count);
+    std::cout << "   Objects that allocated a heap buffer: " << heapObjects << std::endl;
+
+    double longMs = MeasureBestMs(runs, [&]() {
+        heapObjects = 0;
+        for (int i = 0; i < count; i++)
+        {
+            StringUtility text(longText);
+            text.SetString(longText);
+            heapObjects += text.IsInline() ? 0 : 1;
+        }
+    });
+    PrintRate("Construct + SetString, 54 chars", longMs, count);
+    std::cout << "   Objects that allocated a heap buffer: " << heapObjects << std::endl;
+    std::cout << std::endl;
+}
+
+// 1 MB built from 10-byte pieces: appends copy at the end of a geometrically grown buffer
+void RunStringAppendBenchmark()
+{
+    const int pieces = 100000;
+    const int runs = 3;
+    const char* piece = "0123456789";
+
+    std::cout << "StringUtility::Append (" << pieces << " x 10-byte pieces = 1 MB):" << std::endl;
+
+    int finalLength = 0;
+    int finalCapacity = 0;
+    double appendMs = MeasureBestMs(runs, [&]() {
+        StringUtility text;
+        for (int i = 0; i < pieces; i++)
+            text.Append(piece);
+        finalLength = text.GetLength();
+        finalCapacity = text.Capacity();
+    });
+    PrintRate("Append, geometric growth", appendMs, pieces);
+
+    double reservedMs = MeasureBestMs(runs, [&]() {
+        StringUtility text;
+        text.Reserve(pieces * 10);
+        for (int i = 0; i < pieces; i++)
+            text.Append(piece);
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("Append after Reserve", reservedMs, pieces);
+
+    double stdMs = MeasureBestMs(runs, [&]() {
+        std::string text;
+        for (int i = 0; i < pieces; i++)
+            text += piece;
+        g_sink = g_sink + static_cast<long long>(text.size());
+    });
+    PrintRate("std::string += (reference)", stdMs, pieces);
+    std::cout << "   Final length " << finalLength << ", capacity " << finalCapacity << std::endl;
+    std::cout << std::endl;
+}
+
+// Copies of a 1 MB string: deep copy, copy-on-write share, and move
+void RunStringCopyBenchmark()
+{
+    const int copies = 1000;
+    const int runs = 3;
+    std::string payload(1 << 20, 'x');
+
+    std::cout << "StringUtility copies (" << copies << " copies of a 1 MB string):" << std::endl;
+
+    StringUtility source(payload.c_str());
+    double deepMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < copies; i++)
+        {
+            StringUtility copy(source);
+            g_sink = g_sink + copy.GetLength();
+        }
+    });
+    PrintRate("Deep copy", deepMs, copies);
+
+    source.EnableCopyOnWrite();
+    double sharedMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < copies; i++)
+        {
+            StringUtility copy(source);
+            g_sink = g_sink + copy.GetLength();
+        }
+    });
+    PrintRate("Copy-on-write copy", sharedMs, copies);
+
+    double moveMs = MeasureBestMs(runs, [&]() {
+        StringUtility current(source);
+        for (int i = 0; i < copies; i++)
+        {
+            StringUtility next(std::move(current));
+            current = std::move(next);
+        }
+        g_sink = g_sink + current.GetLength();
+    });
+    PrintRate("Move construct + move assign", moveMs, copies);
+    PrintSpeedup("copy-on-write vs deep copy", deepMs, sharedMs);
+    std::cout << std::endl;
+}
+
+void RunRopeEditBenchmark()
+{
+    const int edits = 2000;
+    const int runs = 3;
+    std::string document;
+    for (int i = 0; document.size() < (8u << 20); i++)
+        document += "The quick brown fox jumps over the lazy dog.\n";
+    const char* insertion = "inserted text ";
+    const int documentLength = static_cast<int>(document.size());
+
+    std::cout << "StringUtility splicing (" << edits << " inserts + erases in the middle of an 8 MB document):" << std::endl;
+
+    double flatMs = MeasureBestMs(runs, [&]() {
+        StringUtility text(document.c_str());
+        for (int i = 0; i < edits; i++)
+        {
+            int position = (documentLength / 2 + i * 7919) % documentLength;
+            text.Insert(position, insertion);
+            text.Erase(position + 4, 5);
+        }
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("Contiguous buffer", flatMs, documentLength);
+
+    TextProcessor processor;
+    int ropeWords = 0;
+    double ropeMs = MeasureBestMs(runs, [&]() {
+        StringUtility text(document.c_str());
+        text.EnableRopeMode();
+        for (int i = 0; i < edits; i++)
+        {
+            int position = (documentLength / 2 + i * 7919) % documentLength;
+            text.Insert(position, insertion);
+            text.Erase(position + 4, 5);
+        }
+        ropeWords = processor.CountWords(*text.GetRope());
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("Rope mode (+ chunked CountWords)", ropeMs, documentLength);
+    PrintSpeedup("rope vs contiguous", flatMs, ropeMs);
+    std::cout << "   Words after editing: " << ropeWords << std::endl;
+    std::cout << std::endl;
+}
+
+void RunCaseConversionBenchmark()
+{
+    const int length = 16 << 20;
+    const int runs = 5;
+    std::string text;
+    text.reserve(length + 64);
+    while (static_cast<int>(text.size()) < length)
+        text += "the Quick brown FOX jumps over\tthe lazy dog.\n";
+    text.resize(length);
+
+    std::cout << "Case conversion (" << (length >> 20) << " MB, kernel: " << GetTextKernelName() << "):" << std::endl;
+
+    // Baseline: the per-byte locale call ToUpperCase used before
+    std::string scratch = text;
+    double perByteMs = MeasureBestMs(runs, [&]() {
+        for (size_t i = 0; i < scratch.size(); i++)
+            scratch[i] = static_cast<char>(toupper(static_cast<unsigned char>(scratch[i])));
+        g_sink = g_sink + scratch[0];
+    });
+    PrintRate("toupper per byte", perByteMs, length);
+
+    StringUtility utility(text.c_str());
+    double upperMs = MeasureBestMs(runs, [&]() {
+        utility.ToUpperCase();
+        g_sink = g_sink + utility.GetString()[0];
+    });
+    PrintRate("StringUtility::ToUpperCase", upperMs, length);
+
+    TextProcessor processor;
+    double capitalizeMs = MeasureBestMs(runs, [&]() {
+        std::string result = processor.CapitalizeWords(text);
+        g_sink = g_sink + result[0];
+    });
+    PrintRate("TextProcessor::CapitalizeWords", capitalizeMs, length);
+    PrintSpeedup("ToUpperCase vs per-byte toupper", perByteMs, upperMs);
+    std::cout << std::endl;
+}
+
+void RunStringAllocatorBenchmark()
+{
+    const int requests = 2000;
+    const int stringsPerRequest = 64;
+    const int threadCount = 4;
+    const int runs = 3;
+    const std::string line = "  request header field with some words in it  ";
+
+    std::cout << "String allocation (" << threadCount << " threads x " << requests << " requests, "
+              << stringsPerRequest << " strings + 3 results each):" << std::endl;
+
+    // resource == nullptr: global heap; arenaPerThread: one MonotonicArena per thread, reset after every request
+    auto runWorkers = [&](std::pmr::memory_resource* resource, bool arenaPerThread) {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threadCount; t++)
+        {
+            workers.emplace_back([&, resource, arenaPerThread]() {
+                TextProcessor processor;
+                MonotonicArena arena;
+                std::pmr::memory_resource* target = arenaPerThread ? &arena : resource;
+                size_t total = 0;
+                for (int request = 0; request < requests; request++)
+                {
+                    {
+                        std::vector<StringUtility> strings;
+                        strings.reserve(stringsPerRequest);
+                        for (int i = 0; i < stringsPerRequest; i++)
+                        {
+                            strings.emplace_back(line.c_str(), target);
+                            strings.back().Append(" - appended value");
+                        }
+                        std::pmr::string trimmed = processor.ProcessText(line, target);
+                        std::pmr::string compact = processor.RemoveWhitespace(line, target);
+                        std::pmr::string title = processor.CapitalizeWords(line, target);
+                        total += strings.back().GetLength() + trimmed.size() + compact.size() + title.size();
+                    }
+                    if (arenaPerThread)
+                        arena.Reset();
+                }
+                g_sink = g_sink + static_cast<long long>(total);
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+    };
+
+    const double allocations = static_cast<double>(threadCount) * requests * (stringsPerRequest + 3);
+    double heapMs = MeasureBestMs(runs, [&]() { runWorkers(nullptr, false); });
+    PrintRate("Global heap", heapMs, allocations);
+    double poolMs = MeasureBestMs(runs, [&]() { runWorkers(&SizeClassPool::Instance(), false); });
+    PrintRate("SizeClassPool (thread caches)", poolMs, allocations);
+    double arenaMs = MeasureBestMs(runs, [&]() { runWorkers(nullptr, true); });
+    PrintRate("MonotonicArena, reset per request", arenaMs, allocations);
+    PrintSpeedup("arena vs global heap", heapMs, arenaMs);
+    std::cout << std::endl;
+}
+
+void RunStringInternBenchmark()
+{
+    const int vocabularySize = 1000;
+    const int comparisons = 10000000;
+    const int runs = 3;
+
+    // Long shared prefixes make strcmp walk most of each string, as with qualified identifiers
+    std::vector<std::string> vocabulary;
+    for (int i = 0; i < vocabularySize; i++)
+        vocabulary.push_back("com.example.service.request.field_" + std::to_string(i));
+
+    std::cout << "String interning (" << vocabularySize << " strings, " << comparisons << " equality checks):" << std::endl;
+
+    std::vector<unsigned int> handles(vocabularySize);
+    double internMs = MeasureBestMs(runs, [&]() {
+        for (int i = 0; i < vocabularySize; i++)
+            handles[i] = InternString(vocabulary[i].c_str());
+    });
+    PrintRate("InternString (already interned)", internMs, vocabularySize);
+
+    double compareMs = MeasureBestMs(runs, [&]() {
+        long long equal = 0;
+        int a = 0;
+        int b = 0;
+        for (int i = 0; i < comparisons; i++)
+        {
+            equal += (CompareStrings(vocabulary[a].c_str(), vocabulary[b].c_str()) == 0);
+            a = (a + 7 < vocabularySize) ? a + 7 : a + 7 - vocabularySize;
+            b = (b + 13 < vocabularySize) ? b + 13 : b + 13 - vocabularySize;
+        }
+        g_sink = g_sink + equal;
+    });
+    PrintRate("CompareStrings", compareMs, comparisons);
+
+    double handleMs = MeasureBestMs(runs, [&]() {
+        long long equal = 0;
+        int a = 0;
+        int b = 0;
+        for (int i = 0; i < comparisons; i++)
+        {
+            equal += (handles[a] == handles[b]);
+            a = (a + 7 < vocabularySize) ? a + 7 : a + 7 - vocabularySize;
+            b = (b + 13 < vocabularySize) ? b + 13 : b + 13 - vocabularySize;
+        }
+        g_sink = g_sink + equal;
+    });
+    PrintRate("Handle equality", handleMs, comparisons);
+    PrintSpeedup("handles vs CompareStrings", compareMs, handleMs);
+
+    InternerStatistics stats;
+    GetInternerStatistics(&stats);
+    std::cout << "   Interner memory: " << stats.stringCount << " strings, " << stats.stringBytes << " text bytes, "
+              << (stats.arenaBytes + stats.tableBytes + stats.directoryBytes) << " bytes reserved" << std::endl;
+    std::cout << std::endl;
+}
+
+void RunStringPrimitivesBenchmark()
+{
+    const size_t lengths[] = { 8, 64, 512, 4 << 10, 32 << 10, 1 << 20 };
+    const size_t bytesPerRun = 32 << 20;
+    const int runs = 3;
+
+    std::cout << "String primitives (GB/s, kernel: " << GetTextKernelName() << "):" << std::endl;
+    std::cout << "   " << std::setw(8) << "Size" << std::setw(12) << "Length" << std::setw(9) << "strlen"
+              << std::setw(10) << "Compare" << std::setw(9) << "strcmp" << std::setw(10) << "Reverse"
+              << std::setw(12) << "swap loop" << std::endl;
+
+    std::ios::fmtflags flags = std::cout.flags();
+    for (size_t length : lengths)
+    {
+        std::string first(length, '\0');
+        for (size_t i = 0; i < length; i++)
+            first[i] = static_cast<char>('a' + i % 26);
+        // Equal strings in separate buffers: the compare has to reach the terminator
+        std::string second = first;
+        const size_t calls = (bytesPerRun / length > 0) ? bytesPerRun / length : 1;
+        const double gigabytes = static_cast<double>(calls) * length / 1e9;
+
+        // Read through volatile pointers so the libc calls cannot be hoisted out of the loops
+        const char* volatile text = first.c_str();
+        const char* volatile other = second.c_str();
+        auto timeCalls = [&](auto call) {
+            return MeasureBestMs(runs, [&]() {
+                long long total = 0;
+                for (size_t i = 0; i < calls; i++)
+                    total += call();
+                g_sink = g_sink + total;
+            });
+        };
+
+        double lengthMs = timeCalls([&]() { return GetStringLength(text); });
+        double strlenMs = timeCalls([&]() { return static_cast<int>(strlen(text)); });
+        double compareMs = timeCalls([&]() { return CompareStrings(text, other); });
+        double strcmpMs = timeCalls([&]() { return strcmp(text, other); });
+        double reverseMs = timeCalls([&]() {
+            ReverseString(&first[0], static_cast<int>(length));
+            return first[0];
+        });
+        // Baseline: the two-pointer loop ReverseString used before
+        double swapMs = timeCalls([&]() {
+            char* start = &second[0];
+            char* end = start + length - 1;
+            while (start < end)
+            {
+                char temp = *start;
+                *start++ = *end;
+                *end-- = temp;
+            }
+            return second[0];
+        });
+
+        std::string label = (length >= (1 << 20)) ? std::to_string(length >> 20) + " MB"
+                          : (length >= (1 << 10)) ? std::to_string(length >> 10) + " KB"
+                          : std::to_string(length) + " B";
+        std::cout << "   " << std::setw(8) << label << std::fixed << std::setprecision(2)
+                  << std::setw(12) << gigabytes / (lengthMs / 1000.0) << std::setw(9) << gigabytes / (strlenMs / 1000.0)
+                  << std::setw(10) << gigabytes / (compareMs / 1000.0) << std::setw(9) << gigabytes / (strcmpMs / 1000.0)
+                  << std::setw(10) << gigabytes / (reverseMs / 1000.0) << std::setw(12) << gigabytes / (swapMs / 1000.0)
+                  << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout << std::endl;
+}
+
+void RunNumericAppendBenchmark()
+{
+    const int count = 200000;
+    const int runs = 3;
+
+    std::cout << "Numeric append (" << count << " numbers per string):" << std::endl;
+
+    // Baseline: the to_string temporary per number that the Part 3 demo used
+    double toStringMs = MeasureBestMs(runs, [&]() {
+        StringUtility text;
+        for (int i = 0; i < count; i++)
+        {
+            text.Append(std::to_string(i * 7919LL - 500000).c_str());
+            text.Append(",");
+        }
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("Append(std::to_string(n))", toStringMs, count);
+
+    double appendIntMs = MeasureBestMs(runs, [&]() {
+        StringUtility text;
+        for (int i = 0; i < count; i++)
+        {
+            text.AppendInt(i * 7919LL - 500000);
+            text.Append(",");
+        }
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("AppendInt", appendIntMs, count);
+
+    double snprintfMs = MeasureBestMs(runs, [&]() {
+        StringUtility text;
+        char buffer[64];
+        for (int i = 0; i < count; i++)
+        {
+            snprintf(buffer, sizeof(buffer), "%.17g,", i * 0.37);
+            text.Append(buffer);
+        }
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("Append(snprintf(\"%.17g\"))", snprintfMs, count);
+
+    double appendDoubleMs = MeasureBestMs(runs, [&]() {
+        StringUtility text;
+        for (int i = 0; i < count; i++)
+        {
+            text.AppendDouble(i * 0.37);
+            text.Append(",");
+        }
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("AppendDouble (shortest round-trip)", appendDoubleMs, count);
+
+    double formatMs = MeasureBestMs(runs, [&]() {
+        StringUtility text;
+        for (int i = 0; i < count; i++)
+            text.AppendFormat("id=%d x=%.3f;", i, i * 0.37);
+        g_sink = g_sink + text.GetLength();
+    });
+    PrintRate("AppendFormat(\"id=%d x=%.3f;\")", formatMs, count);
+    PrintSpeedup("AppendInt vs to_string", toStringMs, appendIntMs);
+    PrintSpeedup("AppendDouble vs snprintf", snprintfMs, appendDoubleMs);
+    std::cout << std::endl;
+}
+
+void RunTextViewBenchmark()
+{
+    const int count = 200000;
+    const int runs = 3;
+    const char* const record = "   GET /index.html 200 1043 ms=17   \n";
+    const size_t recordLength = strlen(record);
+
+    std::cout << "Zero-copy TextProcessor (" << count << " records of " << recordLength << " bytes):" << std::endl;
+
+    // Baseline: the copy a (pointer, length) caller had to make, then a new result string per call
+    TextProcessor processor;
+    double copyMs = MeasureBestMs(runs, [&]() {
+        size_t total = 0;
+        for (int i = 0; i < count; i++)
+        {
+            std::string input(record, recordLength);
+            total += processor.ProcessText(input).size();
+        }
+        g_sink = g_sink + static_cast<long long>(total);
+    });
+    PrintRate("ProcessText(std::string(p, n))", copyMs, count);
+
+    double viewMs = MeasureBestMs(runs, [&]() {
+        size_t total = 0;
+        for (int i = 0; i < count; i++)
+            total += processor.Trim(std::string_view(record, recordLength)).size();
+        g_sink = g_sink + static_cast<long long>(total);
+    });
+    PrintRate("Trim(string_view)", viewMs, count);
+
+    std::string output;
+    double reuseMs = MeasureBestMs(runs, [&]() {
+        size_t total = 0;
+        for (int i = 0; i < count; i++)
+        {
+            processor.CapitalizeWords(std::string_view(record, recordLength), output);
+            total += output.size();
+        }
+        g_sink = g_sink + static_cast<long long>(total);
+    });
+    PrintRate("CapitalizeWords(view, output)", reuseMs, count);
+
+    std::vector<std::string_view> fields;
+    double splitMs = MeasureBestMs(runs, [&]() {
+        size_t total = 0;
+        for (int i = 0; i < count; i++)
+            total += processor.Split(processor.Trim(std::string_view(record, recordLength)), ' ', fields);
+        g_sink = g_sink + static_cast<long long>(total);
+    });
+    PrintRate("Trim + Split(' ') into views", splitMs, count);
+    PrintSpeedup("Trim vs copying ProcessText", copyMs, viewMs);
+    std::cout << std::endl;
+}
+
+void RunTextCountBenchmark()
+{
+    const int length = 64 << 20;
+    const int runs = 3;
+    std::string text;
+    text.reserve(length + 64);
+    while (static_cast<int>(text.size()) < length)
+        text += "the Quick brown FOX jumps over\tthe lazy dog.\n  indented line with  double  spaces\n";
+    text.resize(length);
+
+    std::cout << "Word and line counting (" << (length >> 20) << " MB, kernel: " << GetTextKernelName() << "):" << std::endl;
+
+    // Baselines: the stream extraction CountWords used before, and the byte-at-a-time newline loop
+    double streamMs = MeasureBestMs(runs, [&]() {
+        std::istringstream stream(text);
+        std::string word;
+        int count = 0;
+        while (stream >> word)
+            count++;
+        g_sink = g_sink + count;
+    });
+    PrintRate("istringstream >> word", streamMs, length);
+
+    double byteLoopMs = MeasureBestMs(runs, [&]() {
+        int count = 1;
+        for (char c : text)
+        {
+            if (c == '\n')
+                count++;
+        }
+        g_sink = g_sink + count;
+    });
+    PrintRate("'\\n' byte loop", byteLoopMs, length);
+
+    TextProcessor processor;
+    double wordsMs = MeasureBestMs(runs, [&]() {
+        g_sink = g_sink + processor.CountWords(text);
+    });
+    PrintRate("TextProcessor::CountWords", wordsMs, length);
+
+    double linesMs = MeasureBestMs(runs, [&]() {
+        g_sink = g_sink + processor.CountLines(text);
+    });
+    PrintRate("TextProcessor::CountLines", linesMs, length);
+    PrintSpeedup("CountWords vs istringstream", streamMs, wordsMs);
+    PrintSpeedup("CountLines vs byte loop", byteLoopMs, linesMs);
+    std::cout << std::endl;
+}
+
+void RunTextFileBenchmark(long long fileBytes)
+{
+    const char* path = "text_benchmark.txt";
+    const char* outPath = "text_benchmark_out.txt";
+    {
+        const std::string line = "2024-05-01T12:00:00Z INFO request served in 17 ms\tstatus=200 bytes=1043\n";
+        std::ofstream file(path, std::ios::binary);
+        for (long long written = 0; written < fileBytes; written += static_cast<long long>(line.size()))
+            file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        if (!file)
+        {
+            std::cout << "Text file processing: could not write " << path << std::endl << std::endl;
+            return;
+        }
+    }
+
+    std::cout << "Text file processing (" << (fileBytes >> 20) << " MB file):" << std::endl;
+
+    // Baseline: materialize the whole file in a std::string, then count
+    TextProcessor processor;
+    int loadedWords = 0;
+    double loadMs = MeasureBestMs(3, [&]() {
+        std::ifstream file(path, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        loadedWords = processor.CountWords(text);
+    });
+    PrintRate("Read into string + CountWords", loadMs, static_cast<double>(fileBytes));
+
+    TextFileProcessor fileProcessor;
+    long long words = 0;
+    double wordsMs = MeasureBestMs(3, [&]() { fileProcessor.CountWords(path, &words); });
+    PrintRate("TextFileProcessor::CountWords", wordsMs, static_cast<double>(fileBytes));
+
+    long long lines = 0;
+    double linesMs = MeasureBestMs(3, [&]() { fileProcessor.CountLines(path, &lines); });
+    PrintRate("TextFileProcessor::CountLines", linesMs, static_cast<double>(fileBytes));
+
+    double capitalizeMs = MeasureBestMs(3, [&]() { fileProcessor.CapitalizeWords(path, outPath); });
+    PrintRate("TextFileProcessor::CapitalizeWords", capitalizeMs, static_cast<double>(fileBytes));
+    PrintSpeedup("mapped CountWords vs load", loadMs, wordsMs);
+    std::cout << "   Window " << (fileProcessor.GetWindowSize() >> 20) << " MB, words " << loadedWords << " / " << words
+              << ", lines " << lines << std::endl;
+    std::cout << std::endl;
+    std::remove(path);
+    std::remove(outPath);
+}
+
+void RunParallelTextBenchmark(long long textBytes)
+{
+    const int runs = 3;
+    std::string text;
+    text.reserve(static_cast<size_t>(textBytes) + 128);
+    while (static_cast<long long>(text.size()) < textBytes)
+        text += "the Quick brown FOX jumps over\tthe lazy dog.\n  indented line with  double  spaces\n";
+
+    TextProcessor processor;
+    ParallelTextProcessor parallel;
+    std::cout << "Parallel TextProcessor (" << (textBytes >> 20) << " MB, " << parallel.GetThreadCount()
+              << " threads):" << std::endl;
+
+    double wordsMs = MeasureBestMs(runs, [&]() { g_sink = g_sink + processor.CountWords(text); });
+    PrintRate("TextProcessor::CountWords", wordsMs, static_cast<double>(text.size()));
+    long long parallelWords = 0;
+    double parallelWordsMs = MeasureBestMs(runs, [&]() { parallelWords = parallel.CountWords(text); });
+    PrintRate("ParallelTextProcessor::CountWords", parallelWordsMs, static_cast<double>(text.size()));
+
+    double linesMs = MeasureBestMs(runs, [&]() { g_sink = g_sink + processor.CountLines(text); });
+    PrintRate("TextProcessor::CountLines", linesMs, static_cast<double>(text.size()));
+    double parallelLinesMs = MeasureBestMs(runs, [&]() { g_sink = g_sink + parallel.CountLines(text); });
+    PrintRate("ParallelTextProcessor::CountLines", parallelLinesMs, static_cast<double>(text.size()));
+
+    // Output strings are kept across runs so the timings do not include the first allocation
+    std::string compact;
+    double removeMs = MeasureBestMs(runs, [&]() { processor.RemoveWhitespace(text, compact); });
+    PrintRate("TextProcessor::RemoveWhitespace", removeMs, static_cast<double>(text.size()));
+    std::string parallelCompact;
+    double parallelRemoveMs = MeasureBestMs(runs, [&]() { parallel.RemoveWhitespace(text, parallelCompact); });
+    PrintRate("ParallelTextProcessor::RemoveWhitespace", parallelRemoveMs, static_cast<double>(text.size()));
+
+    PrintSpeedup("parallel CountWords", wordsMs, parallelWordsMs);
+    PrintSpeedup("parallel RemoveWhitespace", removeMs, parallelRemoveMs);
+    std::cout << "   Results identical: "
+              << ((parallelWords == processor.CountWords(text) && parallelCompact == compact) ? "yes" : "NO") << std::endl;
+    std::cout << std::endl;
+}
+
+void RunTextPipelineBenchmark()
+{
+    const int length = 64 << 20;
+    const int runs = 3;
+    std::string text;
+    text.reserve(length + 128);
+    while (static_cast<int>(text.size()) < length)
+        text += "  the Quick brown FOX jumps over\tthe lazy dog.\n  indented line with  double  spaces\n";
+    text.resize(length);
+
+    std::cout << "Fused TextPipeline (" << (length >> 20) << " MB, ProcessText -> CapitalizeWords -> RemoveWhitespace + counts):"
+              << std::endl;
+
+    // Baseline: one TextProcessor call per stage, each walking the text and allocating a new string
+    TextProcessor processor;
+    std::string chained;
+    int chainedWords = 0;
+    double chainMs = MeasureBestMs(runs, [&]() {
+        chained = processor.RemoveWhitespace(processor.CapitalizeWords(processor.ProcessText(text)));
+        chainedWords = processor.CountWords(chained) + processor.CountLines(chained);
+    });
+    PrintRate("TextProcessor call chain", chainMs, length);
+
+    TextPipeline pipeline;
+    pipeline.ProcessText().CapitalizeWords().RemoveWhitespace();
+    std::string fused;
+    TextPipelineStatistics stats = { 0, 0, 0 };
+    double fusedMs = MeasureBestMs(runs, [&]() { pipeline.Run(text, fused, &stats); });
+    PrintRate("TextPipeline::Run", fusedMs, length);
+    PrintSpeedup("fused vs chained", chainMs, fusedMs);
+    std::cout << "   " << pipeline.GetStageCount() << " stages -> " << pipeline.GetPlanStepCount() << " steps, output "
+              << (fused == chained && stats.words + stats.lines == chainedWords ? "identical" : "DIFFERENT") << std::endl;
+    std::cout << std::endl;
+}
+
+void RunTextStreamBenchmark()
+{
+    const int length = 64 << 20;
+    const size_t fragmentSize = 1460;  // One TCP segment of payload
+    const int runs = 3;
+    std::string text;
+    text.reserve(length + 128);
+    while (static_cast<int>(text.size()) < length)
+        text += "the Quick brown FOX jumps over\tthe lazy dog.\n  indented line with  double  spaces\n";
+    text.resize(length);
+    const double fragments = static_cast<double>((text.size() + fragmentSize - 1) / fragmentSize);
+
+    std::cout << "Streaming TextProcessor (" << (length >> 20) << " MB in " << fragmentSize << "-byte fragments):" << std::endl;
+
+    // Baseline: buffer every fragment, then run the stateless methods on the whole text
+    TextProcessor processor;
+    std::string buffered;
+    double bufferedMs = MeasureBestMs(runs, [&]() {
+        buffered.clear();
+        for (size_t offset = 0; offset < text.size(); offset += fragmentSize)
+            buffered.append(text, offset, fragmentSize);
+        std::string capitalized = processor.CapitalizeWords(buffered);
+        g_sink = g_sink + processor.CountWords(buffered) + processor.CountLines(buffered) + capitalized[0];
+    });
+    PrintRate("Buffer all + TextProcessor", bufferedMs, fragments);
+
+    TextStreamSession session(TEXT_STREAM_CAPITALIZE_WORDS);
+    TextStreamStatistics stats = { 0, 0, 0 };
+    double streamMs = MeasureBestMs(runs, [&]() {
+        size_t emitted = 0;
+        for (size_t offset = 0; offset < text.size(); offset += fragmentSize)
+        {
+            size_t fragment = (text.size() - offset < fragmentSize) ? text.size() - offset : fragmentSize;
+            emitted += session.Feed(text.data() + offset, fragment).size();
+        }
+        session.Finish(&stats);
+        g_sink = g_sink + static_cast<long long>(emitted);
+    });
+    PrintRate("TextStreamSession::Feed", streamMs, fragments);
+    PrintSpeedup("streaming vs buffering", bufferedMs, streamMs);
+    std::ios::fmtflags flags = std::cout.flags();
+    std::cout << "   " << std::fixed << std::setprecision(0) << (streamMs * 1e6 / fragments) << " ns per fragment, words "
+              << stats.words << " / " << processor.CountWords(text) << ", lines " << stats.lines << std::endl;
+    std::cout.flags(flags);
+    std::cout << std::endl;
+}
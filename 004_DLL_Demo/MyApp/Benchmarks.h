@@ -0,0 +1,38 @@
+//*******************************************************************************************************************
+//**  Benchmarks.h - Performance Benchmarks for the DLL Demo
+//**  Each benchmark prints its own timings; main.cpp runs them in the performance part of the demo
+//********************************************************************************************************************
+
+#pragma once
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// MyLibrary benchmarks
+void RunBatchArithmeticBenchmark();
+void RunConcurrentAccumulatorBenchmark();
+void RunIntegerDivideBenchmark();
+void RunParallelReductionBenchmark(long long elementCount);
+void RunStreamingReducerBenchmark(long long elementCount);
+
+// MyLibrary + MyLibrary002 benchmarks
+void RunObjectLifetimeBenchmark();
+void RunInstrumentationBenchmark();
+
+// MyLibrary002 benchmarks
+void RunSmallStringBenchmark();
+void RunStringAppendBenchmark();
+void RunStringCopyBenchmark();
+void RunRopeEditBenchmark();
+void RunCaseConversionBenchmark();
+void RunStringAllocatorBenchmark();
+void RunStringInternBenchmark();
+void RunStringPrimitivesBenchmark();
+void RunNumericAppendBenchmark();
+void RunTextViewBenchmark();
+void RunTextCountBenchmark();
+void RunTextFileBenchmark(long long fileBytes);
+void RunParallelTextBenchmark(long long textBytes);
+void RunTextPipelineBenchmark();
+void RunTextStreamBenchmark();
+
+#endif // BENCHMARKS_H
@@ -3,13 +3,23 @@
 //**  Demonstrates how to import and use functions and classes from multiple DLL libraries
 //********************************************************************************************************************
 
+#include <cstring>
 #include <iostream>
 #include <string>
 #include "..\MyLibrary\MyLibrary.h"
 #include "..\MyLibrary002\MyLibrary002.h"
+#include "Benchmarks.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+    // The benchmarks take about a minute and write a 256 MB temporary file, so they only run when asked for
+    bool runBenchmarks = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench") == 0)
+            runBenchmarks = true;
+    }
+
     std::cout << "========================================" << std::endl;
     std::cout << "    Multiple DLL Usage Demo Program" << std::endl;
     std::cout << "========================================" << std::endl;
@@ -49,6 +59,37 @@ int main()
     std::cout << "   calc2.Add(15, 25) = " << calc2.Add(15, 25) << std::endl;
     std::cout << std::endl;
 
+    // 4. Using the header-only Calculator template from MyLibrary (inlined, no DLL call)
+    std::cout << "4. Using header-only MyLib::Calculator<T, OverflowPolicy> template:" << std::endl;
+    std::cout << "   Calculator<int>::Add(2147483647, 1) = " << MyLib::Calculator<int>::Add(2147483647, 1) << std::endl;
+    std::cout << "   Calculator<int, SaturateOverflow>::Add(2147483647, 1) = "
+              << MyLib::Calculator<int, MyLib::SaturateOverflow>::Add(2147483647, 1) << std::endl;
+    try
+    {
+        MyLib::Calculator<long long, MyLib::CheckedOverflow>::Multiply(1LL << 62, 4);
+    }
+    catch (const std::overflow_error& e)
+    {
+        std::cout << "   Calculator<long long, CheckedOverflow>::Multiply(2^62, 4) threw: " << e.what() << std::endl;
+    }
+    std::cout << std::endl;
+
+    // 5. Using the expression engine from MyLibrary (compile once, evaluate over columns)
+    std::cout << "5. Using ExpressionEngine from MyLibrary:" << std::endl;
+    const CompiledExpression* expr = GetExpressionEngineInstance().Compile("(price - cost) * qty / 100");
+    double priceColumn[] = { 120.0, 99.5, 250.0 };
+    double costColumn[] = { 100.0, 80.0, 200.0 };
+    double qtyColumn[] = { 10.0, 4.0, 1.0 };
+    const double* columns[3];
+    columns[expr->FindVariable("price")] = priceColumn;
+    columns[expr->FindVariable("cost")] = costColumn;
+    columns[expr->FindVariable("qty")] = qtyColumn;
+    double exprResults[3];
+    expr->EvaluateBatch(columns, 3, exprResults);
+    std::cout << "   \"" << expr->GetSource() << "\" over 3 rows = "
+              << exprResults[0] << ", " << exprResults[1] << ", " << exprResults[2] << std::endl;
+    std::cout << std::endl;
+
     // ============================================================================
     // Part 2: Using MyLibrary002 (Second DLL)
     // ============================================================================
@@ -116,6 +157,35 @@ int main()
     std::string multiLine = "Line 1\nLine 2\nLine 3";
     int lineCount = textProc.CountLines(multiLine);
     std::cout << "   CountLines (for \"" << multiLine << "\"): " << lineCount << std::endl;
+
+    // Views into inputText: no copies, no allocations
+    std::string_view trimmed = textProc.Trim(inputText);
+    std::cout << "   Trim (view): \"" << trimmed << "\"" << std::endl;
+    std::cout << "   Words:";
+    TextTokenizer words(trimmed);
+    std::string_view word;
+    while (words.Next(&word))
+        std::cout << " [" << word << "]";
+    std::cout << std::endl;
+
+    // Three stages and the counts in one pass
+    TextPipeline pipeline;
+    pipeline.ProcessText().CapitalizeWords().RemoveWhitespace();
+    std::string piped;
+    TextPipelineStatistics pipeStats;
+    pipeline.Run(inputText, piped, &pipeStats);
+    std::cout << "   Pipeline (ProcessText -> CapitalizeWords -> RemoveWhitespace): \"" << piped << "\", "
+              << pipeStats.outputBytes << " bytes" << std::endl;
+
+    // The same text arriving in fragments that split words
+    TextStreamSession stream(TEXT_STREAM_CAPITALIZE_WORDS);
+    std::string streamed;
+    const char* const fragments[] = { "hello wo", "rld fr", "om dll" };
+    for (const char* fragment : fragments)
+        streamed += stream.Feed(fragment, strlen(fragment));
+    TextStreamStatistics streamStats;
+    stream.Finish(&streamStats);
+    std::cout << "   Streamed CapitalizeWords: \"" << streamed << "\", " << streamStats.words << " words" << std::endl;
     std::cout << std::endl;
 
     // 4. Using singleton pattern from MyLibrary002
@@ -143,15 +213,57 @@ int main()
     
     StringUtility resultStr;
     resultStr.SetString("Result: ");
-    resultStr.Append(std::to_string(result1).c_str());
+    resultStr.AppendInt(result1);
     resultStr.Append(" + ");
-    resultStr.Append(std::to_string(result2).c_str());
+    resultStr.AppendInt(result2);
     resultStr.Append(" = ");
-    resultStr.Append(std::to_string(result1 + result2).c_str());
+    resultStr.AppendInt(result1 + result2);
     
     std::cout << "   " << resultStr.GetString() << std::endl;
+
+    StringUtility formatStr;
+    formatStr.AppendFormat("Ratio: %d / %d = %g (%.2f%%)", result1, result2,
+                           static_cast<double>(result1) / result2, 100.0 * result1 / result2);
+    std::cout << "   " << formatStr.GetString() << std::endl;
     std::cout << std::endl;
 
+    // ============================================================================
+    // Part 4: Performance benchmarks (MyApp --bench)
+    // ============================================================================
+    if (runBenchmarks)
+    {
+        std::cout << "========== Part 4: Performance Benchmarks ==========" << std::endl;
+        std::cout << std::endl;
+
+        RunBatchArithmeticBenchmark();
+        RunConcurrentAccumulatorBenchmark();
+        RunIntegerDivideBenchmark();
+        RunParallelReductionBenchmark(1LL << 24);
+        RunStreamingReducerBenchmark(1LL << 24);
+        RunObjectLifetimeBenchmark();
+        RunInstrumentationBenchmark();
+        RunSmallStringBenchmark();
+        RunStringAppendBenchmark();
+        RunStringCopyBenchmark();
+        RunRopeEditBenchmark();
+        RunCaseConversionBenchmark();
+        RunStringAllocatorBenchmark();
+        RunStringInternBenchmark();
+        RunStringPrimitivesBenchmark();
+        RunNumericAppendBenchmark();
+        RunTextViewBenchmark();
+        RunTextCountBenchmark();
+        RunTextFileBenchmark(256LL << 20);
+        RunParallelTextBenchmark(256LL << 20);
+        RunTextPipelineBenchmark();
+        RunTextStreamBenchmark();
+    }
+    else
+    {
+        std::cout << "(Part 4: performance benchmarks skipped; run with --bench)" << std::endl;
+        std::cout << std::endl;
+    }
+
     std::cout << "========================================" << std::endl;
     std::cout << "Demo completed! Press any key to exit..." << std::endl;
     std::cin.get();
@@ -0,0 +1,465 @@
+//*******************************************************************************************************************
+//**  BatchMath.cpp - Batch (Array) Arithmetic Implementation
+//**  AVX2/SSE2/scalar kernels for the AddArray/SubtractArray/MultiplyArray/DivideArray(Ex)/DivideArrayByScalar* exports
+//********************************************************************************************************************
+
+#include "MyLibrary.h"
+#include "../Common/CpuFeatures.h"
+#include "MyLibraryInstrumentation.h"
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// ============================================================================
+// Scalar kernels (also used for the tail of every SIMD kernel)
+// ============================================================================
+
+namespace
+{
+    // The wrap policy gives the same two's complement results as the SIMD kernels without signed overflow UB
+    void AddScalar(const int* a, const int* b, int* out, int count)
+    {
+        for (int i = 0; i < count; i++)
+            out[i] = MyLib::Calculator<int>::Add(a[i], b[i]);
+    }
+
+    void SubtractScalar(const int* a, const int* b, int* out, int count)
+    {
+        for (int i = 0; i < count; i++)
+            out[i] = MyLib::Calculator<int>::Subtract(a[i], b[i]);
+    }
+
+    void MultiplyScalar(const int* a, const int* b, int* out, int count)
+    {
+        for (int i = 0; i < count; i++)
+            out[i] = MyLib::Calculator<int>::Multiply(a[i], b[i]);
+    }
+
+    // Value written to lanes with a zero divisor: fill | (sign(a) ^ sign(b)) & signMask
+    // signMask is only set for the infinity policy, so every policy shares one branch-free select
+    struct DivideFill
+    {
+        double fill;
+        unsigned long long signMask;
+    };
+
+    inline unsigned long long DoubleBits(double value)
+    {
+        unsigned long long bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline double BitsToDouble(unsigned long long bits)
+    {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    int DivideScalar(const double* a, const double* b, double* out, int count, const DivideFill& fill, unsigned char* zeroMask)
+    {
+        const unsigned long long fillBits = DoubleBits(fill.fill);
+        int zeroCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            bool isZero = (b[i] == 0.0);
+            double zeroResult = BitsToDouble(fillBits | ((DoubleBits(a[i]) ^ DoubleBits(b[i])) & fill.signMask));
+            out[i] = isZero ? zeroResult : a[i] / b[i];
+            zeroCount += isZero ? 1 : 0;
+            if (zeroMask != nullptr)
+                zeroMask[i] = isZero ? 1 : 0;
+        }
+        return zeroCount;
+    }
+
+    // Invariant-divisor division; also the 64-bit path, which has no vector high multiply before AVX-512
+    template <typename T>
+    void DivideByDividerScalar(const T* values, T* out, int count, const MyLib::Divider<T>& divider)
+    {
+        for (int i = 0; i < count; i++)
+            out[i] = divider.Divide(values[i]);
+    }
+
+#ifdef MYLIB_X86
+    // ============================================================================
+    // SSE2 kernels (4 x int32 / 2 x double per step)
+    // ============================================================================
+
+    void AddSSE2(const int* a, const int* b, int* out, int count)
+    {
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(va, vb));
+        }
+        AddScalar(a + i, b + i, out + i, count - i);
+    }
+
+    void SubtractSSE2(const int* a, const int* b, int* out, int count)
+    {
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi32(va, vb));
+        }
+        SubtractScalar(a + i, b + i, out + i, count - i);
+    }
+
+    // SSE2 has no 32-bit mullo, so multiply even and odd lanes with pmuludq and interleave the low halves
+    inline __m128i MulLo32SSE2(__m128i va, __m128i vb)
+    {
+        __m128i even = _mm_mul_epu32(va, vb);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(va, 32), _mm_srli_epi64(vb, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    void MultiplySSE2(const int* a, const int* b, int* out, int count)
+    {
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), MulLo32SSE2(va, vb));
+        }
+        MultiplyScalar(a + i, b + i, out + i, count - i);
+    }
+
+    // Bit count and per-lane 0/1 bytes for a movemask result of up to 4 lanes
+    const unsigned char kMaskPopCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+    inline void StoreLaneMask(unsigned char* zeroMask, int bits, int lanes)
+    {
+        for (int lane = 0; lane < lanes; lane++)
+            zeroMask[lane] = static_cast<unsigned char>((bits >> lane) & 1);
+    }
+
+    int DivideSSE2(const double* a, const double* b, double* out, int count, const DivideFill& fill, unsigned char* zeroMask)
+    {
+        const __m128d zero = _mm_setzero_pd();
+        const __m128d fillValue = _mm_set1_pd(fill.fill);
+        const __m128d signMask = _mm_castsi128_pd(_mm_set1_epi64x(static_cast<long long>(fill.signMask)));
+        int zeroCount = 0;
+        int i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128d va = _mm_loadu_pd(a + i);
+            __m128d vb = _mm_loadu_pd(b + i);
+            __m128d isZero = _mm_cmpeq_pd(vb, zero);
+            __m128d zeroResult = _mm_or_pd(fillValue, _mm_and_pd(_mm_xor_pd(va, vb), signMask));
+            __m128d quotient = _mm_div_pd(va, vb);
+            _mm_storeu_pd(out + i, _mm_or_pd(_mm_andnot_pd(isZero, quotient), _mm_and_pd(isZero, zeroResult)));
+
+            int bits = _mm_movemask_pd(isZero);
+            zeroCount += kMaskPopCount[bits];
+            if (zeroMask != nullptr)
+                StoreLaneMask(zeroMask + i, bits, 2);
+        }
+        return zeroCount + DivideScalar(a + i, b + i, out + i, count - i, fill, (zeroMask != nullptr) ? zeroMask + i : nullptr);
+    }
+
+    // High 32 bits of each unsigned lane product: pmuludq on even and odd lanes, odd highs already in place
+    inline __m128i MulHighU32SSE2(__m128i values, __m128i magic)
+    {
+        __m128i even = _mm_srli_epi64(_mm_mul_epu32(values, magic), 32);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(values, 32), magic);
+        return _mm_or_si128(even, _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+    }
+
+    // Same steps as MyLib::Divider<T>::Divide on 4 lanes; signed lanes divide magnitudes and restore the sign
+    template <typename T>
+    void DivideByDividerSSE2(const T* values, T* out, int count, const MyLib::Divider<T>& divider)
+    {
+        const __m128i magic = _mm_set1_epi32(static_cast<int>(divider.GetMagic()));
+        const __m128i preShift = _mm_cvtsi32_si128(divider.GetPreShift());
+        const __m128i postShift = _mm_cvtsi32_si128(divider.GetPostShift());
+        const __m128i divisorSign = _mm_set1_epi32(static_cast<int>(divider.GetDivisorSignMask()));
+        const __m128i nonZero = _mm_set1_epi32(static_cast<int>(divider.GetNonZeroMask()));
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            __m128i resultSign = _mm_setzero_si128();
+            if constexpr (std::is_signed<T>::value)
+            {
+                __m128i valueSign = _mm_srai_epi32(value, 31);
+                value = _mm_sub_epi32(_mm_xor_si128(value, valueSign), valueSign);
+                resultSign = _mm_xor_si128(valueSign, divisorSign);
+            }
+            __m128i high = MulHighU32SSE2(value, magic);
+            __m128i quotient = _mm_srl_epi32(_mm_add_epi32(high, _mm_srl_epi32(_mm_sub_epi32(value, high), preShift)), postShift);
+            quotient = _mm_sub_epi32(_mm_xor_si128(quotient, resultSign), resultSign);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_and_si128(quotient, nonZero));
+        }
+        DivideByDividerScalar(values + i, out + i, count - i, divider);
+    }
+
+    // ============================================================================
+    // AVX2 kernels (8 x int32 / 4 x double per step, two vectors per iteration)
+    // ============================================================================
+
+    MYLIB_TARGET_AVX2 void AddAVX2(const int* a, const int* b, int* out, int count)
+    {
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 8));
+            __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(a0, b0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), _mm256_add_epi32(a1, b1));
+        }
+        _mm256_zeroupper();
+        AddSSE2(a + i, b + i, out + i, count - i);
+    }
+
+    MYLIB_TARGET_AVX2 void SubtractAVX2(const int* a, const int* b, int* out, int count)
+    {
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 8));
+            __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi32(a0, b0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), _mm256_sub_epi32(a1, b1));
+        }
+        _mm256_zeroupper();
+        SubtractSSE2(a + i, b + i, out + i, count - i);
+    }
+
+    MYLIB_TARGET_AVX2 void MultiplyAVX2(const int* a, const int* b, int* out, int count)
+    {
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 8));
+            __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mullo_epi32(a0, b0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), _mm256_mullo_epi32(a1, b1));
+        }
+        _mm256_zeroupper();
+        MultiplySSE2(a + i, b + i, out + i, count - i);
+    }
+
+    MYLIB_TARGET_AVX2 int DivideAVX2(const double* a, const double* b, double* out, int count, const DivideFill& fill, unsigned char* zeroMask)
+    {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d fillValue = _mm256_set1_pd(fill.fill);
+        const __m256d signMask = _mm256_castsi256_pd(_mm256_set1_epi64x(static_cast<long long>(fill.signMask)));
+        int zeroCount = 0;
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d va = _mm256_loadu_pd(a + i);
+            __m256d vb = _mm256_loadu_pd(b + i);
+            __m256d isZero = _mm256_cmp_pd(vb, zero, _CMP_EQ_OQ);
+            __m256d zeroResult = _mm256_or_pd(fillValue, _mm256_and_pd(_mm256_xor_pd(va, vb), signMask));
+            _mm256_storeu_pd(out + i, _mm256_blendv_pd(_mm256_div_pd(va, vb), zeroResult, isZero));
+
+            int bits = _mm256_movemask_pd(isZero);
+            zeroCount += kMaskPopCount[bits];
+            if (zeroMask != nullptr)
+                StoreLaneMask(zeroMask + i, bits, 4);
+        }
+        _mm256_zeroupper();
+        return zeroCount + DivideScalar(a + i, b + i, out + i, count - i, fill, (zeroMask != nullptr) ? zeroMask + i : nullptr);
+    }
+
+    MYLIB_TARGET_AVX2 inline __m256i MulHighU32AVX2(__m256i values, __m256i magic)
+    {
+        __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(values, magic), 32);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(values, 32), magic);
+        return _mm256_blend_epi32(even, odd, 0xAA);
+    }
+
+    template <typename T>
+    MYLIB_TARGET_AVX2 void DivideByDividerAVX2(const T* values, T* out, int count, const MyLib::Divider<T>& divider)
+    {
+        const __m256i magic = _mm256_set1_epi32(static_cast<int>(divider.GetMagic()));
+        const __m128i preShift = _mm_cvtsi32_si128(divider.GetPreShift());
+        const __m128i postShift = _mm_cvtsi32_si128(divider.GetPostShift());
+        const __m256i divisorSign = _mm256_set1_epi32(static_cast<int>(divider.GetDivisorSignMask()));
+        const __m256i nonZero = _mm256_set1_epi32(static_cast<int>(divider.GetNonZeroMask()));
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            __m256i resultSign = _mm256_setzero_si256();
+            if constexpr (std::is_signed<T>::value)
+            {
+                __m256i valueSign = _mm256_srai_epi32(value, 31);
+                value = _mm256_abs_epi32(value);
+                resultSign = _mm256_xor_si256(valueSign, divisorSign);
+            }
+            __m256i high = MulHighU32AVX2(value, magic);
+            __m256i quotient = _mm256_srl_epi32(_mm256_add_epi32(high, _mm256_srl_epi32(_mm256_sub_epi32(value, high), preShift)), postShift);
+            quotient = _mm256_sub_epi32(_mm256_xor_si256(quotient, resultSign), resultSign);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(quotient, nonZero));
+        }
+        _mm256_zeroupper();
+        DivideByDividerSSE2(values + i, out + i, count - i, divider);
+    }
+#endif // MYLIB_X86
+
+    // ============================================================================
+    // Runtime dispatch
+    // ============================================================================
+
+    typedef void (*IntArrayKernel)(const int*, const int*, int*, int);
+    typedef int (*DivideArrayKernel)(const double*, const double*, double*, int, const DivideFill&, unsigned char*);
+    typedef void (*IntDividerKernel)(const int*, int*, int, const MyLib::Divider<int>&);
+    typedef void (*UIntDividerKernel)(const unsigned int*, unsigned int*, int, const MyLib::Divider<unsigned int>&);
+
+    struct BatchKernels
+    {
+        SimdLevel level;
+        IntArrayKernel add;
+        IntArrayKernel subtract;
+        IntArrayKernel multiply;
+        DivideArrayKernel divide;
+        IntDividerKernel divideByScalar;
+        UIntDividerKernel divideByScalarU32;
+    };
+
+    BatchKernels SelectKernels()
+    {
+        BatchKernels kernels = { SimdLevel::Scalar, AddScalar, SubtractScalar, MultiplyScalar, DivideScalar,
+                                  DivideByDividerScalar<int>, DivideByDividerScalar<unsigned int> };
+#ifdef MYLIB_X86
+        switch (GetSimdLevel())
+        {
+        case SimdLevel::AVX2:
+            kernels = { SimdLevel::AVX2, AddAVX2, SubtractAVX2, MultiplyAVX2, DivideAVX2,
+                        DivideByDividerAVX2<int>, DivideByDividerAVX2<unsigned int> };
+            break;
+        case SimdLevel::SSE2:
+            kernels = { SimdLevel::SSE2, AddSSE2, SubtractSSE2, MultiplySSE2, DivideSSE2,
+                        DivideByDividerSSE2<int>, DivideByDividerSSE2<unsigned int> };
+            break;
+        default:
+            break;
+        }
+#endif
+        return kernels;
+    }
+
+    const BatchKernels& GetBatchKernels()
+    {
+        static const BatchKernels kernels = SelectKernels();
+        return kernels;
+    }
+}
+
+// ============================================================================
+// C-style batch function implementations
+// ============================================================================
+
+extern "C" {
+    MYLIBRARY_API void AddArray(const int* a, const int* b, int* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_ADD_ARRAY);
+        if (a == nullptr || b == nullptr || out == nullptr || count <= 0)
+            return;
+        GetBatchKernels().add(a, b, out, count);
+    }
+
+    MYLIBRARY_API void SubtractArray(const int* a, const int* b, int* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_SUBTRACT_ARRAY);
+        if (a == nullptr || b == nullptr || out == nullptr || count <= 0)
+            return;
+        GetBatchKernels().subtract(a, b, out, count);
+    }
+
+    MYLIBRARY_API void MultiplyArray(const int* a, const int* b, int* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_MULTIPLY_ARRAY);
+        if (a == nullptr || b == nullptr || out == nullptr || count <= 0)
+            return;
+        GetBatchKernels().multiply(a, b, out, count);
+    }
+
+    MYLIBRARY_API void DivideArray(const double* a, const double* b, double* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_DIVIDE_ARRAY);
+        if (a == nullptr || b == nullptr || out == nullptr || count <= 0)
+            return;
+        // Same as DivideArrayEx with DIVIDE_BY_ZERO_RETURN_ZERO, called directly so it is not counted twice
+        const DivideFill fill = { 0.0, 0 };
+        GetBatchKernels().divide(a, b, out, count, fill, nullptr);
+    }
+
+    MYLIBRARY_API int DivideArrayEx(const double* a, const double* b, double* out, int count,
+                                    DivideByZeroPolicy policy, double sentinel, unsigned char* zeroMask)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_DIVIDE_ARRAY_EX);
+        if (a == nullptr || b == nullptr || out == nullptr || count <= 0)
+            return 0;
+
+        DivideFill fill = { 0.0, 0 };
+        switch (policy)
+        {
+        case DIVIDE_BY_ZERO_RETURN_NAN:
+            fill.fill = std::numeric_limits<double>::quiet_NaN();
+            break;
+        case DIVIDE_BY_ZERO_RETURN_INFINITY:
+            fill.fill = std::numeric_limits<double>::infinity();
+            fill.signMask = 0x8000000000000000ULL;
+            break;
+        case DIVIDE_BY_ZERO_RETURN_SENTINEL:
+            fill.fill = sentinel;
+            break;
+        default:
+            break;
+        }
+        return GetBatchKernels().divide(a, b, out, count, fill, zeroMask);
+    }
+
+    MYLIBRARY_API void DivideArrayByScalar(const int* values, int divisor, int* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR);
+        if (values == nullptr || out == nullptr || count <= 0)
+            return;
+        GetBatchKernels().divideByScalar(values, out, count, MyLib::Divider<int>(divisor));
+    }
+
+    MYLIBRARY_API void DivideArrayByScalarU32(const unsigned int* values, unsigned int divisor, unsigned int* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR_U32);
+        if (values == nullptr || out == nullptr || count <= 0)
+            return;
+        GetBatchKernels().divideByScalarU32(values, out, count, MyLib::Divider<unsigned int>(divisor));
+    }
+
+    MYLIBRARY_API void DivideArrayByScalarI64(const long long* values, long long divisor, long long* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR_I64);
+        if (values == nullptr || out == nullptr || count <= 0)
+            return;
+        DivideByDividerScalar(values, out, count, MyLib::Divider<long long>(divisor));
+    }
+
+    MYLIBRARY_API void DivideArrayByScalarU64(const unsigned long long* values, unsigned long long divisor, unsigned long long* out, int count)
+    {
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR_U64);
+        if (values == nullptr || out == nullptr || count <= 0)
+            return;
+        DivideByDividerScalar(values, out, count, MyLib::Divider<unsigned long long>(divisor));
+    }
+
+    MYLIBRARY_API const char* GetBatchKernelName()
+    {
+        return GetSimdLevelString(GetBatchKernels().level);
+    }
+}
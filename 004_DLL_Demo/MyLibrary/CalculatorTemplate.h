@@ -0,0 +1,213 @@
+//*******************************************************************************************************************
+//**  CalculatorTemplate.h - Header-Only Calculator<T, OverflowPolicy> Template
+//**  Compiled into the caller (no dllimport), so in-process code gets fully inlined arithmetic
+//**  The exported Calculator class and C functions in MyLibrary.h are thin instantiations of it
+//********************************************************************************************************************
+
+#pragma once
+#ifndef CALCULATORTEMPLATE_H
+#define CALCULATORTEMPLATE_H
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace MyLib
+{
+    // ============================================================================
+    // Overflow policies (chosen at compile time)
+    // ============================================================================
+    // OnOverflow receives both candidate results and returns the one the policy wants
+    // OnDivideByZero supplies the result of x / 0 (0 matches Calculator::Divide)
+
+    // Two's complement wrap for integers, plain IEEE results for floating point
+    struct WrapOverflow
+    {
+        template <typename T>
+        static T OnOverflow(T wrapped, T /*saturated*/) { return wrapped; }
+
+        template <typename T>
+        static T OnDivideByZero() { return T(0); }
+    };
+
+    // Clamp to the min/max of T (largest finite value for floating point)
+    struct SaturateOverflow
+    {
+        template <typename T>
+        static T OnOverflow(T /*wrapped*/, T saturated) { return saturated; }
+
+        template <typename T>
+        static T OnDivideByZero() { return T(0); }
+    };
+
+    // Throw std::overflow_error on overflow and std::domain_error on division by zero
+    struct CheckedOverflow
+    {
+        template <typename T>
+        static T OnOverflow(T /*wrapped*/, T /*saturated*/) { throw std::overflow_error("MyLib::Calculator: arithmetic overflow"); }
+
+        template <typename T>
+        static T OnDivideByZero() { throw std::domain_error("MyLib::Calculator: division by zero"); }
+    };
+
+    namespace detail
+    {
+        // 32/64-bit signed integers (int, long, long long, int32_t, int64_t) plus float and double
+        template <typename T>
+        struct IsCalculatorType
+        {
+            static const bool value = (std::is_integral<T>::value && std::is_signed<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)) ||
+                                      std::is_same<T, float>::value || std::is_same<T, double>::value;
+        };
+
+        // Integer add/sub/mul through the unsigned type: defined wrap, overflow detected from the sign bits
+        template <typename T>
+        inline T WrapAdd(T a, T b, bool& overflow)
+        {
+            typedef typename std::make_unsigned<T>::type U;
+            T result = static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+            overflow = ((a ^ result) & (b ^ result)) < 0;
+            return result;
+        }
+
+        template <typename T>
+        inline T WrapSubtract(T a, T b, bool& overflow)
+        {
+            typedef typename std::make_unsigned<T>::type U;
+            T result = static_cast<T>(static_cast<U>(a) - static_cast<U>(b));
+            overflow = ((a ^ b) & (a ^ result)) < 0;
+            return result;
+        }
+
+        template <typename T>
+        inline T WrapMultiply(T a, T b, bool& overflow)
+        {
+            if constexpr (sizeof(T) == 4)
+            {
+                int64_t wide = static_cast<int64_t>(a) * b;
+                T result = static_cast<T>(static_cast<uint32_t>(wide));
+                overflow = (wide != result);
+                return result;
+            }
+            else
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                T result;
+                overflow = __builtin_mul_overflow(a, b, &result);
+                return result;
+#else
+                T result = static_cast<T>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+                const T minValue = (std::numeric_limits<T>::min)();
+                overflow = (a != 0) && ((a == -1 && b == minValue) || (b == -1 && a == minValue) || (result / a != b));
+                return result;
+#endif
+            }
+        }
+    }
+
+    // ============================================================================
+    // Calculator<T, OverflowPolicy>
+    // ============================================================================
+    // Supported T: 32/64-bit signed integers, float, double
+    //   MyLib::Calculator<int>::Add(a, b)                        -> wraps like the hardware
+    //   MyLib::Calculator<int, MyLib::SaturateOverflow>::Add(a, b) -> clamps to INT_MIN/INT_MAX
+    //   MyLib::Calculator<double, MyLib::CheckedOverflow>::Divide(a, 0.0) -> throws std::domain_error
+
+    template <typename T, typename OverflowPolicy = WrapOverflow>
+    class Calculator
+    {
+        static_assert(detail::IsCalculatorType<T>::value, "MyLib::Calculator supports 32/64-bit signed integers, float and double");
+
+    public:
+        typedef T ValueType;
+        typedef OverflowPolicy Policy;
+
+        static T Add(T a, T b)
+        {
+            if constexpr (std::is_integral<T>::value)
+            {
+                bool overflow;
+                T result = detail::WrapAdd(a, b, overflow);
+                if (overflow)
+                    return OverflowPolicy::template OnOverflow<T>(result, (a < 0) ? MinValue() : MaxValue());
+                return result;
+            }
+            else
+            {
+                return CheckFloat(a, b, a + b);
+            }
+        }
+
+        static T Subtract(T a, T b)
+        {
+            if constexpr (std::is_integral<T>::value)
+            {
+                bool overflow;
+                T result = detail::WrapSubtract(a, b, overflow);
+                if (overflow)
+                    return OverflowPolicy::template OnOverflow<T>(result, (a < 0) ? MinValue() : MaxValue());
+                return result;
+            }
+            else
+            {
+                return CheckFloat(a, b, a - b);
+            }
+        }
+
+        static T Multiply(T a, T b)
+        {
+            if constexpr (std::is_integral<T>::value)
+            {
+                bool overflow;
+                T result = detail::WrapMultiply(a, b, overflow);
+                if (overflow)
+                    return OverflowPolicy::template OnOverflow<T>(result, ((a < 0) != (b < 0)) ? MinValue() : MaxValue());
+                return result;
+            }
+            else
+            {
+                return CheckFloat(a, b, a * b);
+            }
+        }
+
+        static T Divide(T a, T b)
+        {
+            if (b == T(0))
+                return OverflowPolicy::template OnDivideByZero<T>();
+            if constexpr (std::is_integral<T>::value)
+            {
+                // MIN / -1 is the only integer quotient that does not fit
+                if (b == T(-1) && a == MinValue())
+                    return OverflowPolicy::template OnOverflow<T>(MinValue(), MaxValue());
+                return a / b;
+            }
+            else
+            {
+                return CheckFloat(a, b, a / b);
+            }
+        }
+
+        static T MinValue()
+        {
+            if constexpr (std::is_integral<T>::value)
+                return (std::numeric_limits<T>::min)();
+            else
+                return std::numeric_limits<T>::lowest();
+        }
+
+        static T MaxValue() { return (std::numeric_limits<T>::max)(); }
+
+    private:
+        // Floating point only overflows when finite operands produce an infinity
+        static T CheckFloat(T a, T b, T result)
+        {
+            const T infinity = std::numeric_limits<T>::infinity();
+            if ((result == infinity || result == -infinity) && a - a == T(0) && b - b == T(0))
+                return OverflowPolicy::template OnOverflow<T>(result, (result > 0) ? MaxValue() : MinValue());
+            return result;
+        }
+    };
+}
+
+#endif // CALCULATORTEMPLATE_H
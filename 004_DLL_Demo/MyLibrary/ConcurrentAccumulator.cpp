@@ -0,0 +1,98 @@
+//*******************************************************************************************************************
+//**  ConcurrentAccumulator.cpp - Sharded Lock-Free Accumulator Implementation
+//**  Backs Calculator's concurrent mode; each thread adds into its own cache-line-padded shard
+//********************************************************************************************************************
+
+#include "MyLibrary.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+namespace
+{
+    const int kCacheLineSize = 64;
+    const int kMinDefaultShards = 64;
+    const int kMaxShards = 1024;
+
+    // Threads get consecutive slots on first use, so up to shardCount threads never share a shard
+    std::atomic<unsigned int> s_nextThreadSlot(0);
+    thread_local unsigned int t_threadSlot = 0;
+    thread_local bool t_hasThreadSlot = false;
+
+    unsigned int GetThreadSlot()
+    {
+        if (!t_hasThreadSlot)
+        {
+            t_threadSlot = s_nextThreadSlot.fetch_add(1, std::memory_order_relaxed);
+            t_hasThreadSlot = true;
+        }
+        return t_threadSlot;
+    }
+
+    int RoundUpToPowerOfTwo(int value)
+    {
+        int result = 1;
+        while (result < value && result < kMaxShards)
+            result <<= 1;
+        return result;
+    }
+}
+
+struct ConcurrentAccumulator::Shard
+{
+    std::atomic<long long> value;
+    char padding[kCacheLineSize - sizeof(std::atomic<long long>)];
+};
+
+ConcurrentAccumulator::ConcurrentAccumulator(int shardCount) : m_shards(nullptr), m_storage(nullptr), m_shardMask(0)
+{
+    if (shardCount <= 0)
+    {
+        int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+        shardCount = (hardwareThreads > kMinDefaultShards) ? hardwareThreads : kMinDefaultShards;
+    }
+    shardCount = RoundUpToPowerOfTwo(shardCount);
+
+    // Align the shard array to a cache line by hand so the first shard does not share a line with its neighbour
+    m_storage = new char[static_cast<size_t>(shardCount) * sizeof(Shard) + kCacheLineSize];
+    uintptr_t address = reinterpret_cast<uintptr_t>(m_storage);
+    uintptr_t aligned = (address + kCacheLineSize - 1) & ~static_cast<uintptr_t>(kCacheLineSize - 1);
+    m_shards = reinterpret_cast<Shard*>(aligned);
+    for (int i = 0; i < shardCount; i++)
+        new (&m_shards[i].value) std::atomic<long long>(0);
+    m_shardMask = shardCount - 1;
+}
+
+ConcurrentAccumulator::~ConcurrentAccumulator()
+{
+    delete[] m_storage;
+    m_storage = nullptr;
+    m_shards = nullptr;
+}
+
+void ConcurrentAccumulator::Add(long long delta)
+{
+    Shard& shard = m_shards[GetThreadSlot() & static_cast<unsigned int>(m_shardMask)];
+    shard.value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+long long ConcurrentAccumulator::GetTotal() const
+{
+    long long total = 0;
+    for (int i = 0; i <= m_shardMask; i++)
+        total = MyLib::Calculator<long long>::Add(total, m_shards[i].value.load(std::memory_order_relaxed));
+    return total;
+}
+
+void ConcurrentAccumulator::Reset(long long value)
+{
+    m_shards[0].value.store(value, std::memory_order_relaxed);
+    for (int i = 1; i <= m_shardMask; i++)
+        m_shards[i].value.store(0, std::memory_order_relaxed);
+}
+
+int ConcurrentAccumulator::GetShardCount() const
+{
+    return m_shardMask + 1;
+}
@@ -0,0 +1,159 @@
+//*******************************************************************************************************************
+//**  Divider.h - Header-Only Invariant-Divisor Integer Division (MyLib::Divider<T>)
+//**  Precomputes a multiply-and-shift magic number once, so every later x / d is a high multiply, a subtract and shifts
+//**  Supports signed and unsigned 32/64-bit integers; the DivideArrayByScalar* exports in MyLibrary.h add SIMD batches
+//********************************************************************************************************************
+
+#pragma once
+#ifndef DIVIDER_H
+#define DIVIDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace MyLib
+{
+    namespace detail
+    {
+        // High half of the full-width unsigned product
+        inline uint32_t MulHigh(uint32_t a, uint32_t b)
+        {
+            return static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 32);
+        }
+
+        inline uint64_t MulHigh(uint64_t a, uint64_t b)
+        {
+#if defined(__SIZEOF_INT128__)
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            return __umulh(a, b);
+#else
+            uint64_t aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+            uint64_t bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+            uint64_t lowLow = aLow * bLow;
+            uint64_t highLow = aHigh * bLow;
+            uint64_t lowHigh = aLow * bHigh;
+            uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + lowHigh;
+            return aHigh * bHigh + (highLow >> 32) + (middle >> 32);
+#endif
+        }
+
+        // floor((high * 2^64) / divisor) for high < divisor; only runs when a Divider is constructed
+        inline uint64_t DivideWide(uint64_t high, uint64_t divisor)
+        {
+            uint64_t quotient = 0;
+            for (int bit = 0; bit < 64; bit++)
+            {
+                bool carry = (high >> 63) != 0;
+                high <<= 1;
+                quotient <<= 1;
+                if (carry || high >= divisor)
+                {
+                    high -= divisor;
+                    quotient |= 1;
+                }
+            }
+            return quotient;
+        }
+    }
+
+    // ============================================================================
+    // Divider<T>
+    // ============================================================================
+    // Round-up method (Granlund-Montgomery), l = ceil(log2 |d|), N = bits of T:
+    //   m = floor(2^N * (2^l - |d|) / |d|) + 1
+    //   t = mulhi(m, |x|),  |x| / |d| = (t + ((|x| - t) >> min(l, 1))) >> max(l - 1, 0)
+    // Signed types divide the magnitudes and restore the sign, so results truncate toward zero like operator/
+    // A zero divisor returns 0 and MIN / -1 wraps to MIN, both matching MyLib::Calculator<T>::Divide
+    //   MyLib::Divider<int> byTen(10);
+    //   int q = byTen.Divide(x);
+
+    template <typename T>
+    class Divider
+    {
+        static_assert(std::is_integral<T>::value && (sizeof(T) == 4 || sizeof(T) == 8),
+                      "MyLib::Divider supports signed and unsigned 32/64-bit integers");
+
+    public:
+        typedef T ValueType;
+        typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type UnsignedType;
+
+        explicit Divider(T divisor = 1)
+        {
+            const int bits = static_cast<int>(sizeof(T) * 8);
+            m_divisor = divisor;
+            m_divisorSign = 0;
+            m_nonZeroMask = (divisor != 0) ? ~UnsignedType(0) : UnsignedType(0);
+
+            UnsignedType magnitude = static_cast<UnsignedType>(divisor);
+            if constexpr (std::is_signed<T>::value)
+            {
+                m_divisorSign = (divisor < 0) ? ~UnsignedType(0) : UnsignedType(0);
+                magnitude = (magnitude ^ m_divisorSign) - m_divisorSign;
+            }
+            if (magnitude == 0)
+                magnitude = 1;
+
+            int log2Ceil = 0;
+            while (log2Ceil < bits && (UnsignedType(1) << log2Ceil) < magnitude)
+                log2Ceil++;
+
+            // 2^l - |d| is always below |d|, so the quotient below fits in N bits
+            UnsignedType excess = (log2Ceil == bits) ? UnsignedType(0 - magnitude) : UnsignedType((UnsignedType(1) << log2Ceil) - magnitude);
+            if constexpr (sizeof(T) == 4)
+                m_magic = static_cast<UnsignedType>((static_cast<uint64_t>(excess) << 32) / magnitude + 1);
+            else
+                m_magic = static_cast<UnsignedType>(detail::DivideWide(excess, magnitude) + 1);
+
+            m_preShift = (log2Ceil < 1) ? log2Ceil : 1;
+            m_postShift = (log2Ceil > 1) ? log2Ceil - 1 : 0;
+        }
+
+        T Divide(T value) const
+        {
+            UnsignedType magnitude = static_cast<UnsignedType>(value);
+            UnsignedType resultSign = 0;
+            if constexpr (std::is_signed<T>::value)
+            {
+                UnsignedType valueSign = (value < 0) ? ~UnsignedType(0) : UnsignedType(0);
+                magnitude = (magnitude ^ valueSign) - valueSign;
+                resultSign = valueSign ^ m_divisorSign;
+            }
+            UnsignedType high = detail::MulHigh(m_magic, magnitude);
+            UnsignedType quotient = (high + ((magnitude - high) >> m_preShift)) >> m_postShift;
+            quotient = (quotient ^ resultSign) - resultSign;
+            return static_cast<T>(quotient & m_nonZeroMask);
+        }
+
+        // Scalar loop, inlined into the caller; use the DivideArrayByScalar* exports for the SIMD kernels
+        void DivideArray(const T* values, T* results, size_t count) const
+        {
+            for (size_t i = 0; i < count; i++)
+                results[i] = Divide(values[i]);
+        }
+
+        T GetDivisor() const { return m_divisor; }
+
+        // Precomputed parameters, used by the vectorized batch kernels
+        UnsignedType GetMagic() const { return m_magic; }
+        int GetPreShift() const { return m_preShift; }
+        int GetPostShift() const { return m_postShift; }
+        UnsignedType GetDivisorSignMask() const { return m_divisorSign; }
+        UnsignedType GetNonZeroMask() const { return m_nonZeroMask; }
+
+    private:
+        T m_divisor;
+        UnsignedType m_magic;
+        UnsignedType m_divisorSign;   // All ones for a negative divisor
+        UnsignedType m_nonZeroMask;   // All zeros for a zero divisor
+        int m_preShift;
+        int m_postShift;
+    };
+}
+
+#endif // DIVIDER_H
@@ -0,0 +1,589 @@
+//*******************************************************************************************************************
+//**  ExpressionEngine.cpp - Expression Compiler and Evaluator Implementation
+//**  Recursive-descent parser -> constant-folded stack bytecode -> block-at-a-time columnar evaluator
+//********************************************************************************************************************
+
+#include "MyLibrary.h"
+#include "MyLibraryInstrumentation.h"
+#include <charconv>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// Bytecode
+// ============================================================================
+
+namespace
+{
+    enum OpCode : unsigned char
+    {
+        OP_PUSH_CONST,
+        OP_PUSH_VAR,
+        OP_ADD,
+        OP_SUBTRACT,
+        OP_MULTIPLY,
+        OP_DIVIDE,
+        OP_NEGATE
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        int operand;  // Constant or variable index for the push instructions
+    };
+
+    // Rows evaluated per bytecode pass in EvaluateBatch; small enough that the block stack stays in L1
+    const int kBlockRows = 256;
+
+    // Deepest nesting of parentheses and unary signs the parser recurses into before it gives up
+    const int kMaxNesting = 256;
+
+    inline double ApplyBinary(OpCode op, double a, double b)
+    {
+        switch (op)
+        {
+        case OP_ADD:
+            return a + b;
+        case OP_SUBTRACT:
+            return a - b;
+        case OP_MULTIPLY:
+            return a * b;
+        default:
+            return MyLib::Calculator<double>::Divide(a, b);
+        }
+    }
+}
+
+struct CompiledExpression::Program
+{
+    std::string source;
+    std::vector<Instruction> code;
+    std::vector<double> constants;
+    std::vector<std::string> variables;
+    int maxStackDepth;
+};
+
+// ============================================================================
+// Parser (recursive descent, emits bytecode with constant folding)
+// ============================================================================
+//   expression := term (('+' | '-') term)*
+//   term       := unary (('*' | '/') unary)*
+//   unary      := ('-' | '+') unary | primary
+//   primary    := number | identifier | '(' expression ')'
+
+namespace
+{
+    class Parser
+    {
+    public:
+        Parser(const char* source, CompiledExpression::Program* program)
+            : m_pos(source), m_begin(source), m_end(source + strlen(source)), m_program(program), m_depth(0), m_nesting(0)
+        {
+        }
+
+        bool Parse(std::string& error)
+        {
+            if (!ParseExpression())
+            {
+                error = m_error;
+                return false;
+            }
+            SkipSpaces();
+            if (m_pos != m_end)
+            {
+                error = FormatError("unexpected character");
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        const char* m_pos;
+        const char* m_begin;
+        const char* m_end;
+        CompiledExpression::Program* m_program;
+        int m_depth;
+        int m_nesting;
+        std::string m_error;
+
+        void SkipSpaces()
+        {
+            while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r'))
+                m_pos++;
+        }
+
+        std::string FormatError(const char* message) const
+        {
+            return std::string(message) + " at position " + std::to_string(m_pos - m_begin);
+        }
+
+        bool Fail(const char* message)
+        {
+            if (m_error.empty())
+                m_error = FormatError(message);
+            return false;
+        }
+
+        void Push(Instruction instruction)
+        {
+            m_program->code.push_back(instruction);
+            m_depth++;
+            if (m_depth > m_program->maxStackDepth)
+                m_program->maxStackDepth = m_depth;
+        }
+
+        void PushConstant(double value)
+        {
+            m_program->constants.push_back(value);
+            Push({ OP_PUSH_CONST, static_cast<int>(m_program->constants.size() - 1) });
+        }
+
+        // The last instruction is a constant push, so its value is known at compile time
+        bool TopIsConstant(size_t fromEnd) const
+        {
+            const std::vector<Instruction>& code = m_program->code;
+            return code.size() > fromEnd && code[code.size() - 1 - fromEnd].op == OP_PUSH_CONST;
+        }
+
+        double PopConstant()
+        {
+            Instruction instruction = m_program->code.back();
+            m_program->code.pop_back();
+            m_depth--;
+            double value = m_program->constants[instruction.operand];
+            if (instruction.operand == static_cast<int>(m_program->constants.size()) - 1)
+                m_program->constants.pop_back();
+            return value;
+        }
+
+        void EmitBinary(OpCode op)
+        {
+            if (TopIsConstant(0) && TopIsConstant(1))
+            {
+                double b = PopConstant();
+                double a = PopConstant();
+                PushConstant(ApplyBinary(op, a, b));
+                return;
+            }
+            m_program->code.push_back({ op, 0 });
+            m_depth--;
+        }
+
+        void EmitNegate()
+        {
+            if (TopIsConstant(0))
+            {
+                PushConstant(-PopConstant());
+                return;
+            }
+            m_program->code.push_back({ OP_NEGATE, 0 });
+        }
+
+        bool ParseExpression()
+        {
+            if (!ParseTerm())
+                return false;
+            for (;;)
+            {
+                SkipSpaces();
+                if (m_pos == m_end || (*m_pos != '+' && *m_pos != '-'))
+                    return true;
+                OpCode op = (*m_pos == '+') ? OP_ADD : OP_SUBTRACT;
+                m_pos++;
+                if (!ParseTerm())
+                    return false;
+                EmitBinary(op);
+            }
+        }
+
+        bool ParseTerm()
+        {
+            if (!ParseUnary())
+                return false;
+            for (;;)
+            {
+                SkipSpaces();
+                if (m_pos == m_end || (*m_pos != '*' && *m_pos != '/'))
+                    return true;
+                OpCode op = (*m_pos == '*') ? OP_MULTIPLY : OP_DIVIDE;
+                m_pos++;
+                if (!ParseUnary())
+                    return false;
+                EmitBinary(op);
+            }
+        }
+
+        // Every parenthesis and unary sign passes through here once, so this is where nesting is counted
+        bool ParseUnary()
+        {
+            if (m_nesting >= kMaxNesting)
+                return Fail("expression nested too deeply");
+            m_nesting++;
+            bool parsed = ParseSignedPrimary();
+            m_nesting--;
+            return parsed;
+        }
+
+        bool ParseSignedPrimary()
+        {
+            SkipSpaces();
+            if (m_pos != m_end && (*m_pos == '-' || *m_pos == '+'))
+            {
+                bool negate = (*m_pos == '-');
+                m_pos++;
+                if (!ParseUnary())
+                    return false;
+                if (negate)
+                    EmitNegate();
+                return true;
+            }
+            return ParsePrimary();
+        }
+
+        bool ParsePrimary()
+        {
+            SkipSpaces();
+            if (m_pos == m_end)
+                return Fail("unexpected end of expression");
+
+            char c = *m_pos;
+            if (c == '(')
+            {
+                m_pos++;
+                if (!ParseExpression())
+                    return false;
+                SkipSpaces();
+                if (m_pos == m_end || *m_pos != ')')
+                    return Fail("expected ')'");
+                m_pos++;
+                return true;
+            }
+
+            if ((c >= '0' && c <= '9') || c == '.')
+            {
+                double value = 0.0;
+                std::from_chars_result parsed = std::from_chars(m_pos, m_end, value);
+                if (parsed.ec != std::errc())
+                    return Fail("invalid number");
+                m_pos = parsed.ptr;
+                PushConstant(value);
+                return true;
+            }
+
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+            {
+                const char* start = m_pos;
+                while (m_pos != m_end && ((*m_pos >= 'a' && *m_pos <= 'z') || (*m_pos >= 'A' && *m_pos <= 'Z') ||
+                                          (*m_pos >= '0' && *m_pos <= '9') || *m_pos == '_'))
+                    m_pos++;
+                std::string name(start, m_pos);
+
+                std::vector<std::string>& variables = m_program->variables;
+                int index = 0;
+                while (index < static_cast<int>(variables.size()) && variables[index] != name)
+                    index++;
+                if (index == static_cast<int>(variables.size()))
+                    variables.push_back(name);
+                Push({ OP_PUSH_VAR, index });
+                return true;
+            }
+
+            return Fail("expected a number, variable or '('");
+        }
+    };
+}
+
+// ============================================================================
+// CompiledExpression class implementation
+// ============================================================================
+
+CompiledExpression::CompiledExpression(Program* program) : m_program(program)
+{
+}
+
+CompiledExpression::~CompiledExpression()
+{
+    delete m_program;
+    m_program = nullptr;
+}
+
+const char* CompiledExpression::GetSource() const
+{
+    return m_program->source.c_str();
+}
+
+int CompiledExpression::GetVariableCount() const
+{
+    return static_cast<int>(m_program->variables.size());
+}
+
+const char* CompiledExpression::GetVariableName(int index) const
+{
+    if (index < 0 || index >= GetVariableCount())
+        return nullptr;
+    return m_program->variables[index].c_str();
+}
+
+int CompiledExpression::FindVariable(const char* name) const
+{
+    if (name == nullptr)
+        return -1;
+    for (int i = 0; i < GetVariableCount(); i++)
+    {
+        if (m_program->variables[i] == name)
+            return i;
+    }
+    return -1;
+}
+
+int CompiledExpression::GetInstructionCount() const
+{
+    return static_cast<int>(m_program->code.size());
+}
+
+double CompiledExpression::Evaluate(const double* values) const
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_EXPRESSION_EVALUATE);
+    // Typical formulas fit the fixed stack, so a single-row call does not allocate
+    const int kFixedStackDepth = 32;
+    double fixedStack[kFixedStackDepth] = {};
+    std::vector<double> heapStack;
+    double* stack = fixedStack;
+    if (m_program->maxStackDepth > kFixedStackDepth)
+    {
+        heapStack.resize(m_program->maxStackDepth);
+        stack = heapStack.data();
+    }
+
+    const double* constants = m_program->constants.data();
+    int top = -1;
+
+    for (const Instruction& instruction : m_program->code)
+    {
+        switch (instruction.op)
+        {
+        case OP_PUSH_CONST:
+            stack[++top] = constants[instruction.operand];
+            break;
+        case OP_PUSH_VAR:
+            stack[++top] = (values != nullptr) ? values[instruction.operand] : 0.0;
+            break;
+        case OP_NEGATE:
+            stack[top] = -stack[top];
+            break;
+        default:
+            stack[top - 1] = ApplyBinary(instruction.op, stack[top - 1], stack[top]);
+            top--;
+            break;
+        }
+    }
+    return stack[0];
+}
+
+// Each stack slot refers to a block of row values (a column slice or scratch) or to a single constant,
+// so constant operands never get broadcast into memory
+namespace
+{
+    struct BlockSlot
+    {
+        const double* values;  // nullptr for a constant slot
+        double constant;
+    };
+
+    template <typename Op>
+    inline void ApplyBlock(const BlockSlot& a, const BlockSlot& b, double* out, int rows, Op op)
+    {
+        if (a.values != nullptr && b.values != nullptr)
+        {
+            for (int i = 0; i < rows; i++)
+                out[i] = op(a.values[i], b.values[i]);
+        }
+        else if (a.values != nullptr)
+        {
+            const double bc = b.constant;
+            for (int i = 0; i < rows; i++)
+                out[i] = op(a.values[i], bc);
+        }
+        else
+        {
+            const double ac = a.constant;
+            for (int i = 0; i < rows; i++)
+                out[i] = op(ac, b.values[i]);
+        }
+    }
+
+    struct AddOp { double operator()(double a, double b) const { return a + b; } };
+    struct SubtractOp { double operator()(double a, double b) const { return a - b; } };
+    struct MultiplyOp { double operator()(double a, double b) const { return a * b; } };
+    struct DivideOp { double operator()(double a, double b) const { return (b == 0.0) ? 0.0 : a / b; } };
+}
+
+void CompiledExpression::EvaluateBatch(const double* const* columns, int rowCount, double* results) const
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_EXPRESSION_EVALUATE_BATCH);
+    if (results == nullptr || rowCount <= 0)
+        return;
+    if (columns == nullptr && GetVariableCount() > 0)
+        return;
+
+    const Program& program = *m_program;
+    const int depth = program.maxStackDepth;
+    std::vector<double> scratch(static_cast<size_t>(depth) * kBlockRows);
+    std::vector<BlockSlot> stack(depth);
+
+    for (int blockStart = 0; blockStart < rowCount; blockStart += kBlockRows)
+    {
+        const int rows = (rowCount - blockStart < kBlockRows) ? (rowCount - blockStart) : kBlockRows;
+        int top = -1;
+
+        for (const Instruction& instruction : program.code)
+        {
+            switch (instruction.op)
+            {
+            case OP_PUSH_CONST:
+                top++;
+                stack[top].values = nullptr;
+                stack[top].constant = program.constants[instruction.operand];
+                break;
+            case OP_PUSH_VAR:
+                top++;
+                stack[top].values = columns[instruction.operand] + blockStart;
+                break;
+            case OP_NEGATE:
+            {
+                // Folding removed constant negations, so the operand is a block
+                double* out = &scratch[static_cast<size_t>(top) * kBlockRows];
+                const double* in = stack[top].values;
+                for (int i = 0; i < rows; i++)
+                    out[i] = -in[i];
+                stack[top].values = out;
+                break;
+            }
+            default:
+            {
+                // Folding guarantees at least one operand is a block
+                double* out = &scratch[static_cast<size_t>(top - 1) * kBlockRows];
+                const BlockSlot& a = stack[top - 1];
+                const BlockSlot& b = stack[top];
+                switch (instruction.op)
+                {
+                case OP_ADD:
+                    ApplyBlock(a, b, out, rows, AddOp());
+                    break;
+                case OP_SUBTRACT:
+                    ApplyBlock(a, b, out, rows, SubtractOp());
+                    break;
+                case OP_MULTIPLY:
+                    ApplyBlock(a, b, out, rows, MultiplyOp());
+                    break;
+                default:
+                    ApplyBlock(a, b, out, rows, DivideOp());
+                    break;
+                }
+                top--;
+                stack[top].values = out;
+                break;
+            }
+            }
+        }
+
+        double* dest = results + blockStart;
+        if (stack[0].values == nullptr)
+        {
+            for (int i = 0; i < rows; i++)
+                dest[i] = stack[0].constant;
+        }
+        else
+        {
+            memcpy(dest, stack[0].values, static_cast<size_t>(rows) * sizeof(double));
+        }
+    }
+}
+
+// ============================================================================
+// ExpressionEngine class implementation
+// ============================================================================
+
+struct ExpressionEngine::Cache
+{
+    mutable std::shared_mutex lock;
+    std::unordered_map<std::string, CompiledExpression*> entries;
+};
+
+ExpressionEngine::ExpressionEngine() : m_cache(new Cache())
+{
+}
+
+ExpressionEngine::~ExpressionEngine()
+{
+    ClearCache();
+    delete m_cache;
+    m_cache = nullptr;
+}
+
+const CompiledExpression* ExpressionEngine::Compile(const char* source, std::string* errorMessage)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_EXPRESSION_COMPILE);
+    if (source == nullptr)
+    {
+        if (errorMessage != nullptr)
+            *errorMessage = "source is null";
+        return nullptr;
+    }
+
+    std::string key(source);
+    {
+        std::shared_lock<std::shared_mutex> readLock(m_cache->lock);
+        auto found = m_cache->entries.find(key);
+        if (found != m_cache->entries.end())
+            return found->second;
+    }
+
+    // Parse outside the lock; if two threads race on the same source the first insert wins
+    CompiledExpression::Program* program = new CompiledExpression::Program();
+    program->source = key;
+    program->maxStackDepth = 0;
+    std::string error;
+    Parser parser(source, program);
+    if (!parser.Parse(error))
+    {
+        delete program;
+        if (errorMessage != nullptr)
+            *errorMessage = error;
+        return nullptr;
+    }
+
+    CompiledExpression* compiled = new CompiledExpression(program);
+    std::unique_lock<std::shared_mutex> writeLock(m_cache->lock);
+    auto inserted = m_cache->entries.emplace(key, compiled);
+    if (!inserted.second)
+        delete compiled;
+    return inserted.first->second;
+}
+
+int ExpressionEngine::GetCacheSize() const
+{
+    std::shared_lock<std::shared_mutex> readLock(m_cache->lock);
+    return static_cast<int>(m_cache->entries.size());
+}
+
+void ExpressionEngine::ClearCache()
+{
+    std::unique_lock<std::shared_mutex> writeLock(m_cache->lock);
+    for (auto& entry : m_cache->entries)
+        delete entry.second;
+    m_cache->entries.clear();
+}
+
+// ============================================================================
+// Singleton function implementation
+// ============================================================================
+
+MYLIBRARY_API ExpressionEngine& GetExpressionEngineInstance()
+{
+    static ExpressionEngine* instance = new ExpressionEngine();
+    return *instance;
+}
@@ -4,7 +4,8 @@
 //********************************************************************************************************************
 
 #include "MyLibrary.h"
-#include <iostream>
+#include "../Common/AsyncLogger.h"
+#include "MyLibraryInstrumentation.h"
 
 // ============================================================================
 // C-style function implementations
@@ -13,17 +14,29 @@
 extern "C" {
     MYLIBRARY_API int Add(int a, int b)
     {
-        return a + b;
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_ADD);
+        return MyLib::Calculator<int>::Add(a, b);
     }
 
     MYLIBRARY_API int Multiply(int a, int b)
     {
-        return a * b;
+        MYLIBRARY_INSTRUMENT(INSTRUMENTED_MULTIPLY);
+        return MyLib::Calculator<int>::Multiply(a, b);
     }
 
     MYLIBRARY_API const char* GetVersion()
     {
-        return "MyLibrary v1.0.0";
+        return "MyLibrary v1.1.0";
+    }
+
+    MYLIBRARY_API void SetInstrumentationEnabled(int enabled)
+    {
+        MyLib::Instrumentation::Registry<MyLibraryInstrumentation>::SetEnabled(enabled != 0);
+    }
+
+    MYLIBRARY_API int GetInstrumentationSnapshot(InstrumentationRecord* records, int capacity)
+    {
+        return MyLib::Instrumentation::Registry<MyLibraryInstrumentation>::Instance().Snapshot(records, capacity);
     }
 }
 
@@ -31,50 +44,117 @@ extern "C" {
 // C++ class implementations
 // ============================================================================
 
-Calculator::Calculator() : m_value(0)
+namespace
+{
+    // A new accumulator holding the same total, or nullptr outside concurrent mode
+    ConcurrentAccumulator* CloneAccumulator(const ConcurrentAccumulator* accumulator)
+    {
+        if (accumulator == nullptr)
+            return nullptr;
+        ConcurrentAccumulator* clone = new ConcurrentAccumulator(accumulator->GetShardCount());
+        clone->Reset(accumulator->GetTotal());
+        return clone;
+    }
+}
+
+Calculator::Calculator() : m_value(0), m_accumulator(nullptr)
+{
+    MYLIB_LOG_DEBUG("[MyLibrary] Calculator object created");
+}
+
+Calculator::Calculator(const Calculator& other)
+    : m_value(other.m_value), m_accumulator(CloneAccumulator(other.m_accumulator))
+{
+}
+
+Calculator& Calculator::operator=(const Calculator& other)
 {
-    std::cout << "[MyLibrary] Calculator object created" << std::endl;
+    if (this != &other)
+    {
+        ConcurrentAccumulator* accumulator = CloneAccumulator(other.m_accumulator);
+        delete m_accumulator;
+        m_accumulator = accumulator;
+        m_value = other.m_value;
+    }
+    return *this;
 }
 
 Calculator::~Calculator()
 {
-    std::cout << "[MyLibrary] Calculator object destroyed" << std::endl;
+    delete m_accumulator;
+    MYLIB_LOG_DEBUG("[MyLibrary] Calculator object destroyed");
 }
 
+// The exported methods are thin wrappers over the header-only template (wrap policy, the pre-template behavior)
 int Calculator::Add(int a, int b)
 {
-    return a + b;
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_CALCULATOR_ADD);
+    return MyLib::Calculator<int>::Add(a, b);
 }
 
 int Calculator::Subtract(int a, int b)
 {
-    return a - b;
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_CALCULATOR_SUBTRACT);
+    return MyLib::Calculator<int>::Subtract(a, b);
 }
 
 int Calculator::Multiply(int a, int b)
 {
-    return a * b;
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_CALCULATOR_MULTIPLY);
+    return MyLib::Calculator<int>::Multiply(a, b);
 }
 
 double Calculator::Divide(double a, double b)
 {
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_CALCULATOR_DIVIDE);
     if (b == 0.0) {
-        std::cout << "[MyLibrary] Warning: Division by zero!" << std::endl;
-        return 0.0;
+        MYLIB_LOG_WARN("[MyLibrary] Warning: Division by zero!");
     }
-    return a / b;
+    return MyLib::Calculator<double>::Divide(a, b);
 }
 
 void Calculator::SetValue(int value)
 {
+    if (m_accumulator != nullptr)
+    {
+        m_accumulator->Reset(value);
+        return;
+    }
     m_value = value;
 }
 
+// The 64-bit total wraps to int, the same value AddToValue gives without concurrent mode
 int Calculator::GetValue() const
 {
+    if (m_accumulator != nullptr)
+        return static_cast<int>(static_cast<unsigned int>(m_accumulator->GetTotal()));
     return m_value;
 }
 
+void Calculator::AddToValue(int delta)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_CALCULATOR_ADD_TO_VALUE);
+    if (m_accumulator != nullptr)
+    {
+        m_accumulator->Add(delta);
+        return;
+    }
+    m_value = MyLib::Calculator<int>::Add(m_value, delta);
+}
+
+void Calculator::EnableConcurrentMode(int shardCount)
+{
+    if (m_accumulator != nullptr)
+        return;
+    m_accumulator = new ConcurrentAccumulator(shardCount);
+    m_accumulator->Reset(m_value);
+}
+
+bool Calculator::IsConcurrentMode() const
+{
+    return m_accumulator != nullptr;
+}
+
 // ============================================================================
 // Singleton function implementation (similar to VerificationSystemInstance)
 // ============================================================================
@@ -16,20 +16,95 @@
 #define MYLIBRARY_API __declspec(dllimport)
 #endif
 
+// Header-only MyLib::Calculator<T, OverflowPolicy>; inlined into the caller, the exports below forward to it
+#include "CalculatorTemplate.h"
+// Header-only MyLib::Divider<T>; precomputed magic-number division by a runtime divisor
+#include "Divider.h"
+// InstrumentationRecord, shared with MyLibrary002
+#include "../Common/Instrumentation.h"
+#include <string>
+
+// Result written by DivideArrayEx for lanes whose divisor is zero
+enum DivideByZeroPolicy
+{
+    DIVIDE_BY_ZERO_RETURN_ZERO = 0,      // 0.0, same as Calculator::Divide
+    DIVIDE_BY_ZERO_RETURN_NAN = 1,       // quiet NaN
+    DIVIDE_BY_ZERO_RETURN_INFINITY = 2,  // +inf or -inf, sign of a[i] xor sign of b[i]
+    DIVIDE_BY_ZERO_RETURN_SENTINEL = 3   // caller-supplied sentinel value
+};
+
 // Export C-style functions
 extern "C" {
     // Simple math function examples
     MYLIBRARY_API int Add(int a, int b);
     MYLIBRARY_API int Multiply(int a, int b);
     MYLIBRARY_API const char* GetVersion();
+
+    // Batch arithmetic over contiguous arrays: out[i] = a[i] op b[i] for i in [0, count)
+    // Kernels (AVX2/SSE2/scalar) are selected once at runtime from CPUID
+    // Integer results wrap on overflow, DivideArray returns 0.0 for a zero divisor like Calculator::Divide
+    MYLIBRARY_API void AddArray(const int* a, const int* b, int* out, int count);
+    MYLIBRARY_API void SubtractArray(const int* a, const int* b, int* out, int count);
+    MYLIBRARY_API void MultiplyArray(const int* a, const int* b, int* out, int count);
+    MYLIBRARY_API void DivideArray(const double* a, const double* b, double* out, int count);
+    MYLIBRARY_API const char* GetBatchKernelName();
+
+    // Branch-free batch divide that never logs: zero divisors are resolved per lane by the policy
+    // zeroMask (optional, count bytes) receives 1 for lanes with a zero divisor, 0 otherwise
+    // Returns the number of zero divisors in the batch
+    MYLIBRARY_API int DivideArrayEx(const double* a, const double* b, double* out, int count,
+                                    DivideByZeroPolicy policy, double sentinel, unsigned char* zeroMask);
+
+    // out[i] = values[i] / divisor through a MyLib::Divider built once per call (truncating, 0 for a zero divisor)
+    // The 32-bit variants run AVX2/SSE2 kernels; the 64-bit variants use the scalar multiply-and-shift
+    MYLIBRARY_API void DivideArrayByScalar(const int* values, int divisor, int* out, int count);
+    MYLIBRARY_API void DivideArrayByScalarU32(const unsigned int* values, unsigned int divisor, unsigned int* out, int count);
+    MYLIBRARY_API void DivideArrayByScalarI64(const long long* values, long long divisor, long long* out, int count);
+    MYLIBRARY_API void DivideArrayByScalarU64(const unsigned long long* values, unsigned long long divisor, unsigned long long* out, int count);
+
+    // Opt-in call counters and latency histograms for the exported functions (disabled by default)
+    // GetInstrumentationSnapshot fills up to capacity records and returns the number of instrumented functions,
+    // so a first call with (nullptr, 0) sizes the buffer. Safe to call while other threads are running.
+    MYLIBRARY_API void SetInstrumentationEnabled(int enabled);
+    MYLIBRARY_API int GetInstrumentationSnapshot(InstrumentationRecord* records, int capacity);
 }
 
+// Sharded accumulator for many threads adding into one total
+// Each thread adds into its own cache-line-padded shard with a relaxed atomic add, so writers never share a line
+// GetTotal() sums the shards and may miss adds that are still in flight
+class MYLIBRARY_API ConcurrentAccumulator
+{
+public:
+    // shardCount is rounded up to a power of two; 0 picks one shard per hardware thread (at least 64)
+    explicit ConcurrentAccumulator(int shardCount = 0);
+    ~ConcurrentAccumulator();
+
+    void Add(long long delta);
+    long long GetTotal() const;       // Wraps past the int64 range
+    void Reset(long long value = 0);  // Not atomic with respect to concurrent Add() calls
+    int GetShardCount() const;
+
+private:
+    struct Shard;
+
+    Shard* m_shards;
+    char* m_storage;
+    int m_shardMask;
+
+    ConcurrentAccumulator(const ConcurrentAccumulator&);
+    ConcurrentAccumulator& operator=(const ConcurrentAccumulator&);
+};
+
 // Export C++ class
 class MYLIBRARY_API Calculator
 {
 public:
     Calculator();
     ~Calculator();
+
+    // Copies take a snapshot of the value; a concurrent-mode copy gets its own accumulator with the same shard count
+    Calculator(const Calculator& other);
+    Calculator& operator=(const Calculator& other);
     
     int Add(int a, int b);
     int Subtract(int a, int b);
@@ -38,13 +113,164 @@ public:
     
     void SetValue(int value);
     int GetValue() const;
+    void AddToValue(int delta);
+
+    // Concurrent accumulator mode: SetValue/GetValue/AddToValue go through a ConcurrentAccumulator,
+    // so many threads can call AddToValue without a lock. Enable it before sharing the object
+    void EnableConcurrentMode(int shardCount = 0);
+    bool IsConcurrentMode() const;
     
 private:
     int m_value;
+    ConcurrentAccumulator* m_accumulator;
+};
+
+// Arithmetic expression compiled to flat stack bytecode (immutable, safe to share across threads)
+// Variables are numbered in order of first appearance; division by zero yields 0.0 like Calculator::Divide
+class MYLIBRARY_API CompiledExpression
+{
+public:
+    const char* GetSource() const;
+    int GetVariableCount() const;
+    const char* GetVariableName(int index) const;
+    int FindVariable(const char* name) const;  // -1 if the expression does not use it
+    int GetInstructionCount() const;
+
+    // One row: values[i] is the value of variable i
+    double Evaluate(const double* values) const;
+
+    // Columnar batch: columns[i] points at rowCount values of variable i, results receives rowCount values
+    // The bytecode is interpreted once per block of rows, so dispatch cost is amortized across the block
+    void EvaluateBatch(const double* const* columns, int rowCount, double* results) const;
+
+    struct Program;  // Opaque bytecode, defined in ExpressionEngine.cpp
+
+private:
+    friend class ExpressionEngine;
+
+    Program* m_program;
+
+    explicit CompiledExpression(Program* program);
+    ~CompiledExpression();
+    CompiledExpression(const CompiledExpression&);
+    CompiledExpression& operator=(const CompiledExpression&);
+};
+
+// Parses infix expressions (+ - * /, unary minus, parentheses, numbers, variables) and caches the compiled form
+// by source string, so the same formula is only parsed once
+class MYLIBRARY_API ExpressionEngine
+{
+public:
+    ExpressionEngine();
+    ~ExpressionEngine();
+
+    // Returns the cached or newly compiled expression, or nullptr on a syntax error (described in errorMessage)
+    // Parentheses and unary signs may nest at most 256 deep
+    // The returned object is owned by the engine and stays valid until ClearCache() or destruction
+    // Every distinct source stays cached, so callers compiling unbounded distinct sources must ClearCache() periodically
+    const CompiledExpression* Compile(const char* source, std::string* errorMessage = nullptr);
+    int GetCacheSize() const;
+    void ClearCache();
+
+private:
+    struct Cache;
+
+    Cache* m_cache;
+
+    ExpressionEngine(const ExpressionEngine&);
+    ExpressionEngine& operator=(const ExpressionEngine&);
+};
+
+// Parallel reductions over large arrays, run on a work-stealing thread pool with one deque per worker
+// The input is cut into fixed leaves of grainSize elements and partial results are combined in a fixed
+// pairwise tree, so floating point results depend only on the grain size, not on thread count or timing
+// Empty inputs return 0 (0 or 1.0 for Product)
+class MYLIBRARY_API ParallelReducer
+{
+public:
+    explicit ParallelReducer(int threadCount = 0);  // 0 = one thread per hardware thread (caller included)
+    ~ParallelReducer();
+
+    void SetGrainSize(long long grainSize);  // Elements per leaf task, default 65536
+    long long GetGrainSize() const;
+    int GetThreadCount() const;
+
+    long long Sum(const int* data, long long count);                // Wraps past the int64 range
+    double Sum(const double* data, long long count);
+    double Product(const double* data, long long count);
+    int Min(const int* data, long long count);
+    int Max(const int* data, long long count);
+    double Min(const double* data, long long count);
+    double Max(const double* data, long long count);
+    long long Dot(const int* a, const int* b, long long count);    // Wraps past the int64 range
+    double Dot(const double* a, const double* b, long long count);
+
+    class WorkStealingPool;  // Opaque, defined in ParallelReducer.cpp
+
+private:
+    WorkStealingPool* m_pool;
+    long long m_grainSize;
+
+    ParallelReducer(const ParallelReducer&);
+    ParallelReducer& operator=(const ParallelReducer&);
+};
+
+// Element type of a flat binary numeric file (native byte order, no header)
+enum NumericFileType
+{
+    NUMERIC_FILE_INT32 = 0,
+    NUMERIC_FILE_INT64 = 1,
+    NUMERIC_FILE_DOUBLE = 2
+};
+
+// Element-wise operation for StreamingReducer::ApplyBinary
+enum BatchOperation
+{
+    BATCH_ADD = 0,
+    BATCH_SUBTRACT = 1,
+    BATCH_MULTIPLY = 2,
+    BATCH_DIVIDE = 3  // Zero divisors give 0, like Calculator::Divide
+};
+
+// Result of one streaming pass over a numeric file
+struct StreamStatistics
+{
+    long long count;
+    long long integerSum;  // Exact sum for integer files (wraps past the int64 range), 0 for double files
+    double sum;            // Floating point sum for every file type
+    double min;            // For every file type; int64 values beyond 2^53 are rounded
+    double max;
+    long long integerMin;  // Exact extremes for integer files, 0 for double files
+    long long integerMax;
+};
+
+// Runs reductions and batch arithmetic directly over memory-mapped numeric files, one window at a time
+// Only one window per file is mapped at a time (sequential access hint), so resident memory is bounded
+// by the window size whatever the file size, and nothing is copied into intermediate vectors
+class MYLIBRARY_API StreamingReducer
+{
+public:
+    StreamingReducer();
+    ~StreamingReducer();
+
+    // Default 16 MB, at most 1 GB (the batch exports take an int element count), rounded up to the mapping granularity
+    void SetWindowSize(long long bytes);
+    long long GetWindowSize() const;
+
+    // false if the file cannot be opened or its size is not a multiple of the element size
+    bool Reduce(const char* path, NumericFileType type, StreamStatistics* stats);
+
+    // outPath[i] = pathA[i] op pathB[i]; both inputs must have the same type and element count
+    bool ApplyBinary(const char* pathA, const char* pathB, NumericFileType type, BatchOperation op, const char* outPath);
+
+private:
+    long long m_windowSize;
 };
 
 // Export singleton function (similar to VerificationSystemInstance)
 MYLIBRARY_API Calculator& GetCalculatorInstance();
+MYLIBRARY_API ExpressionEngine& GetExpressionEngineInstance();
+MYLIBRARY_API ParallelReducer& GetParallelReducerInstance();
 
 #endif // MYLIBRARY_H
 
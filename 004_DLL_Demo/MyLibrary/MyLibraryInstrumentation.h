@@ -0,0 +1,85 @@
+//*******************************************************************************************************************
+//**  MyLibraryInstrumentation.h - Instrumented Function Table for MyLibrary (internal header)
+//**  Function ids and names reported by GetInstrumentationSnapshot, in snapshot order
+//********************************************************************************************************************
+
+#pragma once
+#ifndef MYLIBRARYINSTRUMENTATION_H
+#define MYLIBRARYINSTRUMENTATION_H
+
+#include "../Common/Instrumentation.h"
+
+// Overloads share one id; trivial accessors (GetVersion, Get*Count, ...) are not instrumented
+enum MyLibraryFunction
+{
+    INSTRUMENTED_ADD = 0,
+    INSTRUMENTED_MULTIPLY,
+    INSTRUMENTED_ADD_ARRAY,
+    INSTRUMENTED_SUBTRACT_ARRAY,
+    INSTRUMENTED_MULTIPLY_ARRAY,
+    INSTRUMENTED_DIVIDE_ARRAY,
+    INSTRUMENTED_DIVIDE_ARRAY_EX,
+    INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR,
+    INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR_U32,
+    INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR_I64,
+    INSTRUMENTED_DIVIDE_ARRAY_BY_SCALAR_U64,
+    INSTRUMENTED_CALCULATOR_ADD,
+    INSTRUMENTED_CALCULATOR_SUBTRACT,
+    INSTRUMENTED_CALCULATOR_MULTIPLY,
+    INSTRUMENTED_CALCULATOR_DIVIDE,
+    INSTRUMENTED_CALCULATOR_ADD_TO_VALUE,
+    INSTRUMENTED_EXPRESSION_COMPILE,
+    INSTRUMENTED_EXPRESSION_EVALUATE,
+    INSTRUMENTED_EXPRESSION_EVALUATE_BATCH,
+    INSTRUMENTED_PARALLEL_SUM,
+    INSTRUMENTED_PARALLEL_PRODUCT,
+    INSTRUMENTED_PARALLEL_MIN,
+    INSTRUMENTED_PARALLEL_MAX,
+    INSTRUMENTED_PARALLEL_DOT,
+    INSTRUMENTED_STREAMING_REDUCE,
+    INSTRUMENTED_STREAMING_APPLY_BINARY,
+    INSTRUMENTED_FUNCTION_COUNT
+};
+
+struct MyLibraryInstrumentation
+{
+    static const int kFunctionCount = INSTRUMENTED_FUNCTION_COUNT;
+
+    static const char* GetName(int function)
+    {
+        static const char* const names[] = {
+            "Add",
+            "Multiply",
+            "AddArray",
+            "SubtractArray",
+            "MultiplyArray",
+            "DivideArray",
+            "DivideArrayEx",
+            "DivideArrayByScalar",
+            "DivideArrayByScalarU32",
+            "DivideArrayByScalarI64",
+            "DivideArrayByScalarU64",
+            "Calculator::Add",
+            "Calculator::Subtract",
+            "Calculator::Multiply",
+            "Calculator::Divide",
+            "Calculator::AddToValue",
+            "ExpressionEngine::Compile",
+            "CompiledExpression::Evaluate",
+            "CompiledExpression::EvaluateBatch",
+            "ParallelReducer::Sum",
+            "ParallelReducer::Product",
+            "ParallelReducer::Min",
+            "ParallelReducer::Max",
+            "ParallelReducer::Dot",
+            "StreamingReducer::Reduce",
+            "StreamingReducer::ApplyBinary"
+        };
+        static_assert(sizeof(names) / sizeof(names[0]) == INSTRUMENTED_FUNCTION_COUNT, "one name per MyLibraryFunction");
+        return names[function];
+    }
+};
+
+#define MYLIBRARY_INSTRUMENT(function) MYLIB_INSTRUMENT_SCOPE(MyLibraryInstrumentation, function)
+
+#endif // MYLIBRARYINSTRUMENTATION_H
@@ -0,0 +1,466 @@
+//*******************************************************************************************************************
+//**  ParallelReducer.cpp - Work-Stealing Parallel Reduction Implementation
+//**  Fixed leaves + per-worker deques with lazy binary splitting + deterministic pairwise combine
+//********************************************************************************************************************
+
+#include "MyLibrary.h"
+#include "MyLibraryInstrumentation.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const long long kDefaultGrainSize = 65536;
+
+    // Half-open range of leaf indices
+    struct LeafRange
+    {
+        long long first;
+        long long last;
+    };
+}
+
+// ============================================================================
+// Work-stealing pool
+// ============================================================================
+// The caller is worker 0 and the pool owns threadCount - 1 background workers.
+// Run() deals one contiguous leaf range to every deque. A worker pops from the back of its own deque and splits
+// the range in half until one leaf is left, pushing the upper halves back. Idle workers steal from the front of
+// other deques, which holds the largest ranges left.
+
+class ParallelReducer::WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int threadCount)
+        : m_job(nullptr), m_generation(0), m_remaining(0), m_activeWorkers(0), m_stopping(false)
+    {
+        if (threadCount < 1)
+            threadCount = 1;
+        for (int i = 0; i < threadCount; i++)
+            m_workers.emplace_back(new Worker());
+        for (int i = 1; i < threadCount; i++)
+            m_threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_wakeLock);
+            m_stopping = true;
+        }
+        m_wakeCondition.notify_all();
+        for (std::thread& thread : m_threads)
+            thread.join();
+    }
+
+    int GetThreadCount() const
+    {
+        return static_cast<int>(m_workers.size());
+    }
+
+    // Calls leafTask(leaf) exactly once for every leaf in [0, leafCount), in parallel; returns when all are done
+    void Run(long long leafCount, const std::function<void(long long)>& leafTask)
+    {
+        std::lock_guard<std::mutex> runGuard(m_runLock);
+
+        const long long workerCount = static_cast<long long>(m_workers.size());
+        for (long long i = 0; i < workerCount; i++)
+        {
+            LeafRange range = { leafCount * i / workerCount, leafCount * (i + 1) / workerCount };
+            if (range.first < range.last)
+            {
+                std::lock_guard<std::mutex> guard(m_workers[i]->lock);
+                m_workers[i]->ranges.push_back(range);
+            }
+        }
+
+        m_remaining.store(leafCount, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> guard(m_wakeLock);
+            m_job = &leafTask;
+            m_generation++;
+        }
+        m_wakeCondition.notify_all();
+
+        ProcessUntilDone(0, leafTask);
+
+        // Stop new workers from joining, then wait for the ones still leaving so leafTask can go out of scope
+        {
+            std::lock_guard<std::mutex> guard(m_wakeLock);
+            m_job = nullptr;
+        }
+        while (m_activeWorkers.load(std::memory_order_acquire) > 0)
+            std::this_thread::yield();
+    }
+
+private:
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<LeafRange> ranges;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::mutex m_runLock;
+
+    std::mutex m_wakeLock;
+    std::condition_variable m_wakeCondition;
+    const std::function<void(long long)>* m_job;
+    unsigned long long m_generation;
+    std::atomic<long long> m_remaining;
+    std::atomic<int> m_activeWorkers;
+    bool m_stopping;
+
+    bool PopLocal(int self, LeafRange& range)
+    {
+        Worker& worker = *m_workers[self];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if (worker.ranges.empty())
+            return false;
+        range = worker.ranges.back();
+        worker.ranges.pop_back();
+        return true;
+    }
+
+    bool Steal(int self, LeafRange& range)
+    {
+        const int workerCount = static_cast<int>(m_workers.size());
+        for (int offset = 1; offset < workerCount; offset++)
+        {
+            Worker& victim = *m_workers[(self + offset) % workerCount];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.ranges.empty())
+            {
+                range = victim.ranges.front();
+                victim.ranges.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ProcessUntilDone(int self, const std::function<void(long long)>& leafTask)
+    {
+        while (m_remaining.load(std::memory_order_acquire) > 0)
+        {
+            LeafRange range;
+            if (!PopLocal(self, range) && !Steal(self, range))
+            {
+                // Remaining leaves are running on other workers
+                std::this_thread::yield();
+                continue;
+            }
+
+            while (range.last - range.first > 1)
+            {
+                long long middle = range.first + (range.last - range.first) / 2;
+                LeafRange upper = { middle, range.last };
+                {
+                    std::lock_guard<std::mutex> guard(m_workers[self]->lock);
+                    m_workers[self]->ranges.push_back(upper);
+                }
+                range.last = middle;
+            }
+
+            leafTask(range.first);
+            m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void WorkerLoop(int self)
+    {
+        unsigned long long seenGeneration = 0;
+        for (;;)
+        {
+            const std::function<void(long long)>* job = nullptr;
+            {
+                std::unique_lock<std::mutex> guard(m_wakeLock);
+                m_wakeCondition.wait(guard, [&]() { return m_stopping || (m_job != nullptr && m_generation != seenGeneration); });
+                if (m_stopping)
+                    return;
+                seenGeneration = m_generation;
+                job = m_job;
+                m_activeWorkers.fetch_add(1, std::memory_order_relaxed);
+            }
+            ProcessUntilDone(self, *job);
+            m_activeWorkers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+};
+
+// ============================================================================
+// Leaf kernels (fixed evaluation order, so every leaf is deterministic)
+// ============================================================================
+
+namespace
+{
+    const long long kPairwiseBlock = 128;
+
+    // Pairwise summation: error grows with O(log n) instead of O(n) for a running sum
+    double PairwiseSum(const double* data, long long count)
+    {
+        if (count <= kPairwiseBlock)
+        {
+            double lanes[8] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+            long long i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                for (int lane = 0; lane < 8; lane++)
+                    lanes[lane] += data[i + lane];
+            }
+            for (; i < count; i++)
+                lanes[0] += data[i];
+            return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        }
+        long long half = count / 2;
+        return PairwiseSum(data, half) + PairwiseSum(data + half, count - half);
+    }
+
+    double PairwiseDot(const double* a, const double* b, long long count)
+    {
+        if (count <= kPairwiseBlock)
+        {
+            double lanes[8] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+            long long i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                for (int lane = 0; lane < 8; lane++)
+                    lanes[lane] += a[i + lane] * b[i + lane];
+            }
+            for (; i < count; i++)
+                lanes[0] += a[i] * b[i];
+            return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        }
+        long long half = count / 2;
+        return PairwiseDot(a, b, half) + PairwiseDot(a + half, b + half, count - half);
+    }
+
+    double PairwiseProduct(const double* data, long long count)
+    {
+        if (count <= kPairwiseBlock)
+        {
+            double lanes[4] = { 1.0, 1.0, 1.0, 1.0 };
+            long long i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                for (int lane = 0; lane < 4; lane++)
+                    lanes[lane] *= data[i + lane];
+            }
+            for (; i < count; i++)
+                lanes[0] *= data[i];
+            return (lanes[0] * lanes[1]) * (lanes[2] * lanes[3]);
+        }
+        long long half = count / 2;
+        return PairwiseProduct(data, half) * PairwiseProduct(data + half, count - half);
+    }
+
+    // Combines leaf partials in a fixed binary tree over the leaf index
+    template <typename T, typename Combine>
+    T CombineTree(const std::vector<T>& partials, size_t first, size_t last, Combine combine)
+    {
+        if (last - first == 1)
+            return partials[first];
+        size_t middle = first + (last - first) / 2;
+        return combine(CombineTree(partials, first, middle, combine), CombineTree(partials, middle, last, combine));
+    }
+}
+
+// ============================================================================
+// ParallelReducer class implementation
+// ============================================================================
+
+namespace
+{
+    // Runs leafReduce over every grain-sized leaf on the pool and combines the partials
+    template <typename T, typename LeafReduce, typename Combine>
+    T ReduceLeaves(ParallelReducer::WorkStealingPool* pool, long long count, long long grainSize,
+                   LeafReduce leafReduce, Combine combine)
+    {
+        long long leafCount = (count + grainSize - 1) / grainSize;
+        std::vector<T> partials(static_cast<size_t>(leafCount));
+        std::function<void(long long)> task = [&](long long leaf) {
+            long long begin = leaf * grainSize;
+            long long end = (begin + grainSize < count) ? begin + grainSize : count;
+            partials[static_cast<size_t>(leaf)] = leafReduce(begin, end - begin);
+        };
+
+        if (leafCount == 1)
+            task(0);
+        else
+            pool->Run(leafCount, task);
+        return CombineTree(partials, 0, partials.size(), combine);
+    }
+}
+
+ParallelReducer::ParallelReducer(int threadCount) : m_pool(nullptr), m_grainSize(kDefaultGrainSize)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0)
+            threadCount = 1;
+    }
+    m_pool = new WorkStealingPool(threadCount);
+}
+
+ParallelReducer::~ParallelReducer()
+{
+    delete m_pool;
+    m_pool = nullptr;
+}
+
+void ParallelReducer::SetGrainSize(long long grainSize)
+{
+    m_grainSize = (grainSize > 0) ? grainSize : kDefaultGrainSize;
+}
+
+long long ParallelReducer::GetGrainSize() const
+{
+    return m_grainSize;
+}
+
+int ParallelReducer::GetThreadCount() const
+{
+    return m_pool->GetThreadCount();
+}
+
+long long ParallelReducer::Sum(const int* data, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_SUM);
+    if (data == nullptr || count <= 0)
+        return 0;
+    // Unsigned adds wrap instead of overflowing; the cast back gives the two's complement total
+    unsigned long long sum = ReduceLeaves<unsigned long long>(m_pool, count, m_grainSize,
+        [data](long long begin, long long length) {
+            unsigned long long sum = 0;
+            for (long long i = 0; i < length; i++)
+                sum += static_cast<unsigned long long>(static_cast<long long>(data[begin + i]));
+            return sum;
+        },
+        [](unsigned long long a, unsigned long long b) { return a + b; });
+    return static_cast<long long>(sum);
+}
+
+double ParallelReducer::Sum(const double* data, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_SUM);
+    if (data == nullptr || count <= 0)
+        return 0.0;
+    return ReduceLeaves<double>(m_pool, count, m_grainSize,
+        [data](long long begin, long long length) { return PairwiseSum(data + begin, length); },
+        [](double a, double b) { return a + b; });
+}
+
+double ParallelReducer::Product(const double* data, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_PRODUCT);
+    if (data == nullptr || count <= 0)
+        return 1.0;
+    return ReduceLeaves<double>(m_pool, count, m_grainSize,
+        [data](long long begin, long long length) { return PairwiseProduct(data + begin, length); },
+        [](double a, double b) { return a * b; });
+}
+
+int ParallelReducer::Min(const int* data, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_MIN);
+    if (data == nullptr || count <= 0)
+        return 0;
+    return ReduceLeaves<int>(m_pool, count, m_grainSize,
+        [data](long long begin, long long length) {
+            int result = data[begin];
+            for (long long i = 1; i < length; i++)
+                result = (data[begin + i] < result) ? data[begin + i] : result;
+            return result;
+        },
+        [](int a, int b) { return (b < a) ? b : a; });
+}
+
+int ParallelReducer::Max(const int* data, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_MAX);
+    if (data == nullptr || count <= 0)
+        return 0;
+    return ReduceLeaves<int>(m_pool, count, m_grainSize,
+        [data](long long begin, long long length) {
+            int result = data[begin];
+            for (long long i = 1; i < length; i++)
+                result = (data[begin + i] > result) ? data[begin + i] : result;
+            return result;
+        },
+        [](int a, int b) { return (b > a) ? b : a; });
+}
+
+double ParallelReducer::Min(const double* data, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_MIN);
+    if (data == nullptr || count <= 0)
+        return 0.0;
+    return ReduceLeaves<double>(m_pool, count, m_grainSize,
+        [data](long long begin, long long length) {
+            double result = data[begin];
+            for (long long i = 1; i < length; i++)
+                result = (data[begin + i] < result) ? data[begin + i] : result;
+            return result;
+        },
+        [](double a, double b) { return (b < a) ? b : a; });
+}
+
+double ParallelReducer::Max(const double* data, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_MAX);
+    if (data == nullptr || count <= 0)
+        return 0.0;
+    return ReduceLeaves<double>(m_pool, count, m_grainSize,
+        [data](long long begin, long long length) {
+            double result = data[begin];
+            for (long long i = 1; i < length; i++)
+                result = (data[begin + i] > result) ? data[begin + i] : result;
+            return result;
+        },
+        [](double a, double b) { return (b > a) ? b : a; });
+}
+
+long long ParallelReducer::Dot(const int* a, const int* b, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_DOT);
+    if (a == nullptr || b == nullptr || count <= 0)
+        return 0;
+    // Each product fits in int64 (INT_MIN * INT_MIN is 2^62), but two of them already pass INT64_MAX, so sums wrap
+    unsigned long long sum = ReduceLeaves<unsigned long long>(m_pool, count, m_grainSize,
+        [a, b](long long begin, long long length) {
+            unsigned long long sum = 0;
+            for (long long i = 0; i < length; i++)
+                sum += static_cast<unsigned long long>(static_cast<long long>(a[begin + i]) * b[begin + i]);
+            return sum;
+        },
+        [](unsigned long long x, unsigned long long y) { return x + y; });
+    return static_cast<long long>(sum);
+}
+
+double ParallelReducer::Dot(const double* a, const double* b, long long count)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_PARALLEL_DOT);
+    if (a == nullptr || b == nullptr || count <= 0)
+        return 0.0;
+    return ReduceLeaves<double>(m_pool, count, m_grainSize,
+        [a, b](long long begin, long long length) { return PairwiseDot(a + begin, b + begin, length); },
+        [](double x, double y) { return x + y; });
+}
+
+// ============================================================================
+// Singleton function implementation
+// ============================================================================
+
+MYLIBRARY_API ParallelReducer& GetParallelReducerInstance()
+{
+    static ParallelReducer* instance = new ParallelReducer();
+    return *instance;
+}
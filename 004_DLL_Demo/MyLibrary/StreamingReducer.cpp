@@ -0,0 +1,322 @@
+//*******************************************************************************************************************
+//**  StreamingReducer.cpp - Memory-Mapped Streaming Reductions and Batch Arithmetic
+//**  Walks flat binary numeric files window by window through Common/MappedFile.h
+//********************************************************************************************************************
+
+#include "MyLibrary.h"
+#include "MyLibraryInstrumentation.h"
+#include "../Common/MappedFile.h"
+#include <cstdio>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    const long long kDefaultWindowSize = 16LL * 1024 * 1024;
+
+    // Windows are passed to the batch exports, which take an int element count; 1 GB keeps that far below INT_MAX
+    // for every element type and is a multiple of any mapping granularity
+    const long long kMaxWindowSize = 1LL << 30;
+
+    size_t GetElementSize(NumericFileType type)
+    {
+        switch (type)
+        {
+        case NUMERIC_FILE_INT32:
+            return sizeof(int);
+        case NUMERIC_FILE_INT64:
+            return sizeof(long long);
+        case NUMERIC_FILE_DOUBLE:
+            return sizeof(double);
+        default:
+            return 0;
+        }
+    }
+
+    // Window size rounded up to the mapping granularity, which keeps every window element-aligned
+    size_t GetAlignedWindowSize(long long windowSize)
+    {
+        const size_t granularity = MappedFile::GetGranularity();
+        size_t size = static_cast<size_t>(windowSize);
+        return (size + granularity - 1) / granularity * granularity;
+    }
+
+    FILE* OpenOutputFile(const char* path)
+    {
+#ifdef _WIN32
+        FILE* file = nullptr;
+        if (fopen_s(&file, path, "wb") != 0)
+            return nullptr;
+        return file;
+#else
+        return fopen(path, "wb");
+#endif
+    }
+
+    // Running totals of one pass, kept in the element type so extremes never round-trip through double
+    template <typename T>
+    struct Reduction
+    {
+        long long count;
+        unsigned long long integerSum;
+        double sum;
+        T low;
+        T high;
+    };
+
+    // Four independent accumulators per window so the loop is not bound by add latency
+    template <typename T>
+    void ReduceWindow(const T* data, size_t count, Reduction<T>& state)
+    {
+        T low = (state.count > 0) ? state.low : data[0];
+        T high = (state.count > 0) ? state.high : data[0];
+
+        if constexpr (std::is_integral<T>::value)
+        {
+            unsigned long long lanes[4] = { 0, 0, 0, 0 };
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                for (int lane = 0; lane < 4; lane++)
+                {
+                    lanes[lane] += static_cast<unsigned long long>(static_cast<long long>(data[i + lane]));
+                    low = (data[i + lane] < low) ? data[i + lane] : low;
+                    high = (data[i + lane] > high) ? data[i + lane] : high;
+                }
+            }
+            for (; i < count; i++)
+            {
+                lanes[0] += static_cast<unsigned long long>(static_cast<long long>(data[i]));
+                low = (data[i] < low) ? data[i] : low;
+                high = (data[i] > high) ? data[i] : high;
+            }
+            state.integerSum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        }
+        else
+        {
+            double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                for (int lane = 0; lane < 4; lane++)
+                {
+                    lanes[lane] += data[i + lane];
+                    low = (data[i + lane] < low) ? data[i + lane] : low;
+                    high = (data[i + lane] > high) ? data[i + lane] : high;
+                }
+            }
+            for (; i < count; i++)
+            {
+                lanes[0] += data[i];
+                low = (data[i] < low) ? data[i] : low;
+                high = (data[i] > high) ? data[i] : high;
+            }
+            state.sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        }
+
+        state.low = low;
+        state.high = high;
+        state.count += static_cast<long long>(count);
+    }
+
+    // One pass over every window; the typed totals become StreamStatistics only at the end
+    template <typename T>
+    bool ReduceFile(MappedFile& file, size_t windowSize, StreamStatistics* stats)
+    {
+        Reduction<T> state = { 0, 0, 0.0, T(), T() };
+        for (unsigned long long offset = 0; offset < file.GetSize(); offset += windowSize)
+        {
+            size_t length = 0;
+            const char* window = file.MapWindow(offset, windowSize, &length);
+            if (window == nullptr)
+                return false;
+            ReduceWindow(reinterpret_cast<const T*>(window), length / sizeof(T), state);
+        }
+
+        StreamStatistics result = { state.count, 0, state.sum, 0.0, 0.0, 0, 0 };
+        if (state.count > 0)
+        {
+            result.min = static_cast<double>(state.low);
+            result.max = static_cast<double>(state.high);
+        }
+        if constexpr (std::is_integral<T>::value)
+        {
+            result.integerSum = static_cast<long long>(state.integerSum);
+            result.sum = static_cast<double>(result.integerSum);
+            if (state.count > 0)
+            {
+                result.integerMin = static_cast<long long>(state.low);
+                result.integerMax = static_cast<long long>(state.high);
+            }
+        }
+        *stats = result;
+        return true;
+    }
+
+    // int32 files go through the SIMD batch exports, the other types through the header-only template
+    void ApplyWindow(NumericFileType type, BatchOperation op, const char* a, const char* b, char* out, size_t bytes)
+    {
+        if (type == NUMERIC_FILE_INT32)
+        {
+            const int* ia = reinterpret_cast<const int*>(a);
+            const int* ib = reinterpret_cast<const int*>(b);
+            int* io = reinterpret_cast<int*>(out);
+            int count = static_cast<int>(bytes / sizeof(int));
+            switch (op)
+            {
+            case BATCH_ADD:
+                AddArray(ia, ib, io, count);
+                break;
+            case BATCH_SUBTRACT:
+                SubtractArray(ia, ib, io, count);
+                break;
+            case BATCH_MULTIPLY:
+                MultiplyArray(ia, ib, io, count);
+                break;
+            default:
+                for (int i = 0; i < count; i++)
+                    io[i] = MyLib::Calculator<int>::Divide(ia[i], ib[i]);
+                break;
+            }
+        }
+        else if (type == NUMERIC_FILE_INT64)
+        {
+            typedef MyLib::Calculator<long long> Calc;
+            const long long* la = reinterpret_cast<const long long*>(a);
+            const long long* lb = reinterpret_cast<const long long*>(b);
+            long long* lo = reinterpret_cast<long long*>(out);
+            size_t count = bytes / sizeof(long long);
+            for (size_t i = 0; i < count; i++)
+            {
+                switch (op)
+                {
+                case BATCH_ADD:
+                    lo[i] = Calc::Add(la[i], lb[i]);
+                    break;
+                case BATCH_SUBTRACT:
+                    lo[i] = Calc::Subtract(la[i], lb[i]);
+                    break;
+                case BATCH_MULTIPLY:
+                    lo[i] = Calc::Multiply(la[i], lb[i]);
+                    break;
+                default:
+                    lo[i] = Calc::Divide(la[i], lb[i]);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            const double* da = reinterpret_cast<const double*>(a);
+            const double* db = reinterpret_cast<const double*>(b);
+            double* dout = reinterpret_cast<double*>(out);
+            int count = static_cast<int>(bytes / sizeof(double));
+            switch (op)
+            {
+            case BATCH_ADD:
+                for (int i = 0; i < count; i++)
+                    dout[i] = da[i] + db[i];
+                break;
+            case BATCH_SUBTRACT:
+                for (int i = 0; i < count; i++)
+                    dout[i] = da[i] - db[i];
+                break;
+            case BATCH_MULTIPLY:
+                for (int i = 0; i < count; i++)
+                    dout[i] = da[i] * db[i];
+                break;
+            default:
+                DivideArray(da, db, dout, count);
+                break;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// StreamingReducer class implementation
+// ============================================================================
+
+StreamingReducer::StreamingReducer() : m_windowSize(kDefaultWindowSize)
+{
+}
+
+StreamingReducer::~StreamingReducer()
+{
+}
+
+void StreamingReducer::SetWindowSize(long long bytes)
+{
+    m_windowSize = (bytes > 0) ? bytes : kDefaultWindowSize;
+    if (m_windowSize > kMaxWindowSize)
+        m_windowSize = kMaxWindowSize;
+}
+
+long long StreamingReducer::GetWindowSize() const
+{
+    return static_cast<long long>(GetAlignedWindowSize(m_windowSize));
+}
+
+bool StreamingReducer::Reduce(const char* path, NumericFileType type, StreamStatistics* stats)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_STREAMING_REDUCE);
+    const size_t elementSize = GetElementSize(type);
+    if (stats == nullptr || elementSize == 0)
+        return false;
+    MappedFile file;
+    if (!file.Open(path) || file.GetSize() % elementSize != 0)
+        return false;
+
+    const size_t windowSize = GetAlignedWindowSize(m_windowSize);
+    switch (type)
+    {
+    case NUMERIC_FILE_INT32:
+        return ReduceFile<int>(file, windowSize, stats);
+    case NUMERIC_FILE_INT64:
+        return ReduceFile<long long>(file, windowSize, stats);
+    default:
+        return ReduceFile<double>(file, windowSize, stats);
+    }
+}
+
+bool StreamingReducer::ApplyBinary(const char* pathA, const char* pathB, NumericFileType type, BatchOperation op, const char* outPath)
+{
+    MYLIBRARY_INSTRUMENT(INSTRUMENTED_STREAMING_APPLY_BINARY);
+    const size_t elementSize = GetElementSize(type);
+    if (elementSize == 0 || outPath == nullptr)
+        return false;
+
+    MappedFile fileA;
+    MappedFile fileB;
+    if (!fileA.Open(pathA) || !fileB.Open(pathB))
+        return false;
+    if (fileA.GetSize() != fileB.GetSize() || fileA.GetSize() % elementSize != 0)
+        return false;
+
+    FILE* out = OpenOutputFile(outPath);
+    if (out == nullptr)
+        return false;
+
+    const size_t windowSize = GetAlignedWindowSize(m_windowSize);
+    std::vector<char> buffer(fileA.GetSize() < windowSize ? static_cast<size_t>(fileA.GetSize()) : windowSize);
+    bool ok = true;
+    for (unsigned long long offset = 0; ok && offset < fileA.GetSize(); offset += windowSize)
+    {
+        size_t lengthA = 0;
+        size_t lengthB = 0;
+        const char* windowA = fileA.MapWindow(offset, windowSize, &lengthA);
+        const char* windowB = fileB.MapWindow(offset, windowSize, &lengthB);
+        if (windowA == nullptr || windowB == nullptr || lengthA != lengthB)
+        {
+            ok = false;
+            break;
+        }
+        ApplyWindow(type, op, windowA, windowB, buffer.data(), lengthA);
+        ok = fwrite(buffer.data(), 1, lengthA, out) == lengthA;
+    }
+
+    if (fclose(out) != 0)
+        ok = false;
+    return ok;
+}
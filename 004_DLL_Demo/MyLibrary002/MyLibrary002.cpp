@@ -5,11 +5,17 @@
 
 #include "pch.h"
 #include "MyLibrary002.h"
-#include <iostream>
+#include "../Common/AsyncLogger.h"
+#include "StringInstrumentation.h"
+#include "TextKernels.h"
 #include <cstring>
+#include <climits>
+#include <atomic>
+#include <new>
 #include <algorithm>
-#include <sstream>
 #include <cctype>
+#include <charconv>
+#include <cstdarg>
 
 // ============================================================================
 // C-style function implementations
@@ -26,41 +32,47 @@ extern "C" {
         return "MyLibrary002 v2.0.0";
     }
 
+    MYLIBRARY002_API void SetStringInstrumentationEnabled(int enabled)
+    {
+        MyLib::Instrumentation::Registry<StringInstrumentation>::SetEnabled(enabled != 0);
+    }
+
+    MYLIBRARY002_API int GetStringInstrumentationSnapshot(InstrumentationRecord* records, int capacity)
+    {
+        return MyLib::Instrumentation::Registry<StringInstrumentation>::Instance().Snapshot(records, capacity);
+    }
+
+    MYLIBRARY002_API const char* GetTextKernelName()
+    {
+        return GetSimdLevelString(TextKernels::GetLevel());
+    }
+
     MYLIBRARY002_API int GetStringLength(const char* str)
     {
+        MYLIBRARY002_INSTRUMENT(INSTRUMENTED_GET_STRING_LENGTH);
         if (str == nullptr)
             return 0;
-        return static_cast<int>(strlen(str));
+        return static_cast<int>(TextKernels::StringLength(str));
     }
 
     MYLIBRARY002_API void ReverseString(char* str, int length)
     {
+        MYLIBRARY002_INSTRUMENT(INSTRUMENTED_REVERSE_STRING);
         if (str == nullptr || length <= 0)
             return;
-        
-        char* start = str;
-        char* end = str + length - 1;
-        
-        while (start < end)
-        {
-            char temp = *start;
-            *start = *end;
-            *end = temp;
-            start++;
-            end--;
-        }
+        TextKernels::Reverse(str, static_cast<size_t>(length));
     }
 
     MYLIBRARY002_API int CompareStrings(const char* str1, const char* str2)
     {
+        MYLIBRARY002_INSTRUMENT(INSTRUMENTED_COMPARE_STRINGS);
         if (str1 == nullptr && str2 == nullptr)
             return 0;
         if (str1 == nullptr)
             return -1;
         if (str2 == nullptr)
             return 1;
-        
-        return strcmp(str1, str2);
+        return TextKernels::Compare(str1, str2);
     }
 }
 
@@ -68,41 +80,143 @@ extern "C" {
 // StringUtility class implementation
 // ============================================================================
 
-StringUtility::StringUtility() : m_buffer(nullptr), m_capacity(0), m_length(0)
+// Header in front of every heap buffer; the count only exceeds 1 for copy-on-write copies
+// The block remembers where it came from, so a buffer can outlive (or move away from) the object that allocated it
+struct StringUtility::HeapHeader
 {
-    Resize(16); // Initial capacity
-    m_buffer[0] = '\0';
-    std::cout << "[MyLibrary002] StringUtility object created" << std::endl;
+    std::atomic<int> refCount;
+    int capacity;
+    std::pmr::memory_resource* resource;  // nullptr: global heap
+};
+
+namespace
+{
+    const size_t kHeapHeaderSize = 16;  // Keeps the characters 16-byte aligned behind the header
+    static_assert(sizeof(StringUtility::HeapHeader) <= kHeapHeaderSize, "heap header must fit in front of the characters");
+
+    char* AllocateHeapBuffer(int capacity, std::pmr::memory_resource* resource)
+    {
+        const size_t blockSize = kHeapHeaderSize + static_cast<size_t>(capacity);
+        char* block = (resource != nullptr) ? static_cast<char*>(resource->allocate(blockSize, kHeapHeaderSize)) : new char[blockSize];
+        StringUtility::HeapHeader* header = new (block) StringUtility::HeapHeader();
+        header->refCount.store(1, std::memory_order_relaxed);
+        header->capacity = capacity;
+        header->resource = resource;
+        return block + kHeapHeaderSize;
+    }
+
+    StringUtility::HeapHeader* GetHeapHeader(char* buffer)
+    {
+        return reinterpret_cast<StringUtility::HeapHeader*>(buffer - kHeapHeaderSize);
+    }
+
+    void ReleaseHeapBuffer(char* buffer)
+    {
+        StringUtility::HeapHeader* header = GetHeapHeader(buffer);
+        // Sole owner (the common case) skips the atomic read-modify-write
+        if (header->refCount.load(std::memory_order_acquire) == 1 ||
+            header->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::pmr::memory_resource* resource = header->resource;
+            const size_t blockSize = kHeapHeaderSize + static_cast<size_t>(header->capacity);
+            header->~HeapHeader();
+            char* block = buffer - kHeapHeaderSize;
+            if (resource != nullptr)
+                resource->deallocate(block, blockSize, kHeapHeaderSize);
+            else
+                delete[] block;
+        }
+    }
+}
+
+StringUtility::StringUtility() : m_buffer(m_inlineBuffer), m_capacity(kInlineCapacity), m_length(0), m_copyOnWrite(false), m_resource(nullptr), m_rope(nullptr), m_ropeFlat(false)
+{
+    m_inlineBuffer[0] = '\0';
+    MYLIB_LOG_DEBUG("[MyLibrary002] StringUtility object created");
 }
 
-StringUtility::StringUtility(const char* initialValue) : m_buffer(nullptr), m_capacity(0), m_length(0)
+StringUtility::StringUtility(const char* initialValue) : m_buffer(m_inlineBuffer), m_capacity(kInlineCapacity), m_length(0), m_copyOnWrite(false), m_resource(nullptr), m_rope(nullptr), m_ropeFlat(false)
 {
+    m_inlineBuffer[0] = '\0';
     if (initialValue != nullptr)
     {
-        m_length = static_cast<int>(strlen(initialValue));
-        Resize(m_length + 1);
-        strcpy_s(m_buffer, m_capacity, initialValue);
+        int length = static_cast<int>(strlen(initialValue));
+        Resize(length + 1);
+        memcpy(m_buffer, initialValue, length + 1);
+        m_length = length;
     }
-    else
+    MYLIB_LOG_DEBUG("[MyLibrary002] StringUtility object created with initial value");
+}
+
+StringUtility::StringUtility(const char* initialValue, std::pmr::memory_resource* resource)
+    : m_buffer(m_inlineBuffer), m_capacity(kInlineCapacity), m_length(0), m_copyOnWrite(false), m_resource(resource), m_rope(nullptr), m_ropeFlat(false)
+{
+    m_inlineBuffer[0] = '\0';
+    if (initialValue != nullptr)
     {
-        Resize(16);
-        m_buffer[0] = '\0';
+        int length = static_cast<int>(strlen(initialValue));
+        Resize(length + 1);
+        memcpy(m_buffer, initialValue, length + 1);
+        m_length = length;
     }
-    std::cout << "[MyLibrary002] StringUtility object created with initial value" << std::endl;
+    MYLIB_LOG_DEBUG("[MyLibrary002] StringUtility object created with a memory resource");
 }
 
-StringUtility::~StringUtility()
+StringUtility::StringUtility(const StringUtility& other)
+    : m_buffer(m_inlineBuffer), m_capacity(kInlineCapacity), m_length(0), m_copyOnWrite(false), m_resource(nullptr), m_rope(nullptr), m_ropeFlat(false)
+{
+    m_inlineBuffer[0] = '\0';
+    CopyFrom(other);
+    MYLIB_LOG_DEBUG("[MyLibrary002] StringUtility object copied");
+}
+
+StringUtility::StringUtility(StringUtility&& other) noexcept
+    : m_buffer(m_inlineBuffer), m_capacity(kInlineCapacity), m_length(0), m_copyOnWrite(false), m_resource(nullptr), m_rope(nullptr), m_ropeFlat(false)
+{
+    m_inlineBuffer[0] = '\0';
+    m_resource = other.m_resource;
+    MoveFrom(other);
+}
+
+StringUtility& StringUtility::operator=(const StringUtility& other)
 {
-    if (m_buffer != nullptr)
+    if (this != &other)
     {
-        delete[] m_buffer;
-        m_buffer = nullptr;
+        delete m_rope;
+        m_rope = nullptr;
+        ReleaseBuffer();
+        CopyFrom(other);
     }
-    std::cout << "[MyLibrary002] StringUtility object destroyed" << std::endl;
+    return *this;
+}
+
+StringUtility& StringUtility::operator=(StringUtility&& other) noexcept
+{
+    if (this != &other)
+    {
+        delete m_rope;
+        m_rope = nullptr;
+        ReleaseBuffer();
+        // A buffer from another resource is copied, not adopted, so this object never holds memory it did not ask for
+        if (m_resource == other.m_resource)
+            MoveFrom(other);
+        else
+            CopyFrom(other);
+    }
+    return *this;
+}
+
+StringUtility::~StringUtility()
+{
+    delete m_rope;
+    ReleaseBuffer();
+    m_buffer = nullptr;
+    MYLIB_LOG_DEBUG("[MyLibrary002] StringUtility object destroyed");
 }
 
 void StringUtility::SetString(const char* str)
 {
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_SET_STRING);
     if (str == nullptr)
     {
         Clear();
@@ -110,22 +224,25 @@ void StringUtility::SetString(const char* str)
     }
     
     int newLength = static_cast<int>(strlen(str));
-    if (newLength >= m_capacity)
+    if (m_rope != nullptr)
     {
-        Resize(newLength + 1);
+        *m_rope = Rope(str, newLength);
+        m_length = newLength;
+        m_ropeFlat = false;
+        return;
     }
+    Grow(newLength + 1);
     
-    #ifdef _WIN32
-    strcpy_s(m_buffer, m_capacity, str);
-    #else
-    strncpy(m_buffer, str, m_capacity - 1);
-    m_buffer[m_capacity - 1] = '\0';
-    #endif
+    // memmove: str may point into our own buffer (it then fits, so Grow did not reallocate)
+    memmove(m_buffer, str, newLength + 1);
     m_length = newLength;
 }
 
 const char* StringUtility::GetString() const
 {
+    // Lazy flatten: the buffer is a cache of the rope, so filling it does not change the logical value
+    if (m_rope != nullptr && !m_ropeFlat)
+        const_cast<StringUtility*>(this)->FlattenRope();
     return (m_buffer != nullptr) ? m_buffer : "";
 }
 
@@ -136,192 +253,964 @@ int StringUtility::GetLength() const
 
 void StringUtility::Append(const char* str)
 {
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_APPEND);
     if (str == nullptr)
         return;
-    
+    AppendChars(str, static_cast<int>(strlen(str)));
+}
+
+void StringUtility::Clear()
+{
+    if (m_rope != nullptr)
+    {
+        m_rope->Clear();
+        m_ropeFlat = false;
+    }
+    // A shared buffer is dropped rather than copied just to be emptied
+    if (IsShared())
+        ReleaseBuffer();
+    m_buffer[0] = '\0';
+    m_length = 0;
+}
+
+void StringUtility::ToUpperCase()
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_TO_UPPER_CASE);
+    FlattenRope();
+    MakeUnique();
+    TextKernels::ToUpper(m_buffer, static_cast<size_t>(m_length));
+    if (m_rope != nullptr)
+        *m_rope = Rope(m_buffer, m_length);
+}
+
+void StringUtility::ToLowerCase()
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_TO_LOWER_CASE);
+    FlattenRope();
+    MakeUnique();
+    TextKernels::ToLower(m_buffer, static_cast<size_t>(m_length));
+    if (m_rope != nullptr)
+        *m_rope = Rope(m_buffer, m_length);
+}
+
+bool StringUtility::IsEmpty() const
+{
+    return (m_length == 0);
+}
+
+bool StringUtility::IsInline() const
+{
+    return m_buffer == m_inlineBuffer;
+}
+
+void StringUtility::Reserve(int capacity)
+{
+    FlattenRope();
+    if (capacity + 1 > m_capacity)
+        Resize(capacity + 1);
+}
+
+int StringUtility::Capacity() const
+{
+    return m_capacity - 1;
+}
+
+void StringUtility::ShrinkToFit()
+{
+    // In rope mode the flat copy is only a cache; drop it entirely
+    if (m_rope != nullptr)
+    {
+        int length = m_length;
+        ReleaseBuffer();
+        m_length = length;
+        m_ropeFlat = false;
+        return;
+    }
+    if (m_buffer != m_inlineBuffer && m_capacity > m_length + 1)
+        Resize(m_length + 1);
+}
+
+void StringUtility::EnableCopyOnWrite(bool enabled)
+{
+    m_copyOnWrite = enabled;
+}
+
+bool StringUtility::IsCopyOnWrite() const
+{
+    return m_copyOnWrite;
+}
+
+std::pmr::memory_resource* StringUtility::GetMemoryResource() const
+{
+    return m_resource;
+}
+
+bool StringUtility::IsShared() const
+{
+    return m_buffer != m_inlineBuffer && GetHeapHeader(m_buffer)->refCount.load(std::memory_order_acquire) > 1;
+}
+
+void StringUtility::Insert(int position, const char* str)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_INSERT);
+    if (str == nullptr || *str == '\0')
+        return;
+    if (position < 0)
+        position = 0;
+    if (position > m_length)
+        position = m_length;
+
     int strLen = static_cast<int>(strlen(str));
-    int newLength = m_length + strLen;
-    
-    if (newLength >= m_capacity)
+    if (m_rope != nullptr)
     {
-        Resize(newLength + 1);
+        m_rope->Insert(static_cast<size_t>(position), str, static_cast<size_t>(strLen));
+        m_length += strLen;
+        m_ropeFlat = false;
+        return;
     }
-    
-    #ifdef _WIN32
-    strcat_s(m_buffer, m_capacity, str);
-    #else
-    strncat(m_buffer, str, m_capacity - m_length - 1);
-    m_buffer[m_capacity - 1] = '\0';
-    #endif
-    m_length = newLength;
+
+    // Inserting (part of) ourselves: the source moves with the reallocation and the shift below
+    std::string aliasCopy;
+    if (str >= m_buffer && str < m_buffer + m_length)
+    {
+        aliasCopy.assign(str, strLen);
+        str = aliasCopy.c_str();
+    }
+    Grow(m_length + strLen + 1);
+    memmove(m_buffer + position + strLen, m_buffer + position, m_length - position + 1);
+    memcpy(m_buffer + position, str, strLen);
+    m_length += strLen;
 }
 
-void StringUtility::Clear()
+void StringUtility::Erase(int position, int count)
 {
-    if (m_buffer != nullptr)
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_ERASE);
+    // A range starting before the string is clamped like Insert's position: Erase(-2, 5) erases the first 3 characters
+    if (count <= 0)
+        return;
+    if (position < 0)
+    {
+        count += position;
+        position = 0;
+    }
+    if (count <= 0 || position >= m_length)
+        return;
+    if (count > m_length - position)
+        count = m_length - position;
+
+    if (m_rope != nullptr)
     {
-        m_buffer[0] = '\0';
-        m_length = 0;
+        m_rope->Erase(static_cast<size_t>(position), static_cast<size_t>(count));
+        m_length -= count;
+        m_ropeFlat = false;
+        return;
     }
+
+    MakeUnique();
+    memmove(m_buffer + position, m_buffer + position + count, m_length - position - count + 1);
+    m_length -= count;
 }
 
-void StringUtility::ToUpperCase()
+namespace
+{
+    const char kDigitPairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    int CountDigits(unsigned long long value)
+    {
+        int digits = 1;
+        for (; value >= 100; value /= 100)
+            digits += 2;
+        return (value >= 10) ? digits + 1 : digits;
+    }
+
+    // Writes the digits of value backwards from end, two per division
+    void WriteDigits(char* end, unsigned long long value)
+    {
+        while (value >= 100)
+        {
+            const unsigned long long pair = value % 100;
+            value /= 100;
+            end -= 2;
+            memcpy(end, kDigitPairs + pair * 2, 2);
+        }
+        if (value >= 10)
+            memcpy(end - 2, kDigitPairs + value * 2, 2);
+        else
+            end[-1] = static_cast<char>('0' + value);
+    }
+
+    // Longest %f result: 309 integer digits of DBL_MAX, the point, kMaxPrecision decimals and a sign
+    const int kMaxPrecision = 64;
+    const int kDoubleBufferSize = 384;
+
+    // precision < 0: shortest round-trip form
+    int FormatDouble(char* buffer, double value, std::chars_format format, int precision)
+    {
+        std::to_chars_result result = (precision < 0)
+            ? std::to_chars(buffer, buffer + kDoubleBufferSize, value)
+            : std::to_chars(buffer, buffer + kDoubleBufferSize, value, format, (precision > kMaxPrecision) ? kMaxPrecision : precision);
+        return (result.ec == std::errc()) ? static_cast<int>(result.ptr - buffer) : 0;
+    }
+}
+
+void StringUtility::AppendInt(long long value)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_APPEND);
+    AppendSigned(value);
+}
+
+void StringUtility::AppendUInt(unsigned long long value)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_APPEND);
+    AppendUnsigned(value, CountDigits(value));
+}
+
+void StringUtility::AppendDouble(double value)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_APPEND);
+    char text[kDoubleBufferSize];
+    AppendChars(text, FormatDouble(text, value, std::chars_format::general, -1));
+}
+
+void StringUtility::AppendFormat(const char* format, ...)
 {
-    if (m_buffer == nullptr)
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_STRING_APPEND);
+    if (format == nullptr)
         return;
-    
-    for (int i = 0; i < m_length; i++)
+
+    va_list args;
+    va_start(args, format);
+    const char* literal = format;
+    const char* p = format;
+    while (*p != '\0')
     {
-        m_buffer[i] = static_cast<char>(toupper(static_cast<unsigned char>(m_buffer[i])));
+        if (*p != '%')
+        {
+            p++;
+            continue;
+        }
+        AppendChars(literal, static_cast<int>(p - literal));
+        const char* specifier = p++;
+
+        int precision = -1;
+        if (*p == '.')
+        {
+            precision = 0;
+            for (p++; *p >= '0' && *p <= '9'; p++)
+                precision = (precision < kMaxPrecision) ? precision * 10 + (*p - '0') : precision;
+        }
+        int longs = 0;
+        bool sizeType = false;
+        for (; *p == 'l' || *p == 'z' || *p == 'h'; p++)
+        {
+            if (*p == 'l')
+                longs++;
+            else if (*p == 'z')
+                sizeType = true;
+        }
+
+        switch (*p)
+        {
+        case 'd':
+        case 'i':
+            if (sizeType)
+                AppendSigned(va_arg(args, ptrdiff_t));
+            else if (longs >= 2)
+                AppendSigned(va_arg(args, long long));
+            else if (longs == 1)
+                AppendSigned(va_arg(args, long));
+            else
+                AppendSigned(va_arg(args, int));
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        {
+            unsigned long long value = 0;
+            if (sizeType)
+                value = va_arg(args, size_t);
+            else if (longs >= 2)
+                value = va_arg(args, unsigned long long);
+            else if (longs == 1)
+                value = va_arg(args, unsigned long);
+            else
+                value = va_arg(args, unsigned int);
+            if (*p == 'u')
+            {
+                AppendUnsigned(value, CountDigits(value));
+                break;
+            }
+            const char* hexDigits = (*p == 'x') ? "0123456789abcdef" : "0123456789ABCDEF";
+            char text[16];
+            int start = 16;
+            do
+            {
+                text[--start] = hexDigits[value & 15];
+                value >>= 4;
+            } while (value != 0);
+            AppendChars(text + start, 16 - start);
+            break;
+        }
+        case 'f':
+        case 'e':
+        case 'g':
+        {
+            // %f and %e default to six decimals like printf; %g without a precision is the shortest round-trip form
+            const std::chars_format style = (*p == 'f') ? std::chars_format::fixed
+                                          : (*p == 'e') ? std::chars_format::scientific : std::chars_format::general;
+            if (precision < 0 && *p != 'g')
+                precision = 6;
+            char text[kDoubleBufferSize];
+            AppendChars(text, FormatDouble(text, va_arg(args, double), style, precision));
+            break;
+        }
+        case 's':
+        {
+            const char* str = va_arg(args, const char*);
+            AppendChars((str != nullptr) ? str : "(null)", static_cast<int>(strlen((str != nullptr) ? str : "(null)")));
+            break;
+        }
+        case 'c':
+        {
+            const char c = static_cast<char>(va_arg(args, int));
+            AppendChars(&c, 1);
+            break;
+        }
+        case '%':
+            AppendChars("%", 1);
+            break;
+        default:
+            // Unsupported conversion: keep the text as written
+            if (*p == '\0')
+                p--;
+            AppendChars(specifier, static_cast<int>(p + 1 - specifier));
+            break;
+        }
+        literal = ++p;
     }
+    AppendChars(literal, static_cast<int>(p - literal));
+    va_end(args);
 }
 
-void StringUtility::ToLowerCase()
+void StringUtility::EnableRopeMode(bool enabled)
+{
+    if (enabled && m_rope == nullptr)
+    {
+        m_rope = new Rope(m_buffer, m_length);
+        m_ropeFlat = true;
+    }
+    else if (!enabled && m_rope != nullptr)
+    {
+        FlattenRope();
+        delete m_rope;
+        m_rope = nullptr;
+    }
+}
+
+bool StringUtility::IsRopeMode() const
 {
-    if (m_buffer == nullptr)
+    return m_rope != nullptr;
+}
+
+const Rope* StringUtility::GetRope() const
+{
+    return m_rope;
+}
+
+// Copies the rope into the buffer; its old contents are stale, so nothing is carried over on growth
+void StringUtility::FlattenRope()
+{
+    if (m_rope == nullptr || m_ropeFlat)
         return;
+    const int length = m_length;
+    if (IsShared())
+        ReleaseBuffer();
+    m_length = 0;
+    Grow(length + 1);
+    m_rope->CopyTo(m_buffer);
+    m_buffer[length] = '\0';
+    m_length = length;
+    m_ropeFlat = true;
+}
+
+// Doubles the capacity (at least) whenever it runs out; also unshares the buffer before a write
+void StringUtility::Grow(int requiredCapacity)
+{
+    if (requiredCapacity <= m_capacity)
+    {
+        MakeUnique();
+        return;
+    }
+    int doubled = (m_capacity <= INT_MAX / 2) ? m_capacity * 2 : INT_MAX;
+    Resize((requiredCapacity > doubled) ? requiredCapacity : doubled);
+}
+
+// Appends length bytes that may point into this string
+void StringUtility::AppendChars(const char* text, int length)
+{
+    if (length <= 0)
+        return;
+    int newLength = m_length + length;
+    if (m_rope != nullptr)
+    {
+        m_rope->Append(text, length);
+        m_length = newLength;
+        m_ropeFlat = false;
+        return;
+    }
+    
+    // Appending (part of) ourselves: re-point text after a possible reallocation
+    const bool aliased = (text >= m_buffer && text < m_buffer + m_length);
+    const int aliasOffset = aliased ? static_cast<int>(text - m_buffer) : 0;
+    Grow(newLength + 1);
+    if (aliased)
+        text = m_buffer + aliasOffset;
     
-    for (int i = 0; i < m_length; i++)
+    // Copy at the known end instead of rescanning the buffer
+    memcpy(m_buffer + m_length, text, length);
+    m_buffer[newLength] = '\0';
+    m_length = newLength;
+}
+
+// Makes room for count more characters and returns where they go, so callers format in place
+// nullptr in rope mode, where the text has to go through AppendChars
+char* StringUtility::ExtendBy(int count)
+{
+    if (m_rope != nullptr)
+        return nullptr;
+    Grow(m_length + count + 1);
+    char* destination = m_buffer + m_length;
+    m_length += count;
+    m_buffer[m_length] = '\0';
+    return destination;
+}
+
+void StringUtility::AppendSigned(long long value)
+{
+    if (value >= 0)
+    {
+        AppendUnsigned(static_cast<unsigned long long>(value), CountDigits(static_cast<unsigned long long>(value)));
+        return;
+    }
+    // Negate in unsigned arithmetic so LLONG_MIN does not overflow
+    const unsigned long long magnitude = 0ULL - static_cast<unsigned long long>(value);
+    const int digits = CountDigits(magnitude);
+    char* destination = ExtendBy(digits + 1);
+    if (destination != nullptr)
     {
-        m_buffer[i] = static_cast<char>(tolower(static_cast<unsigned char>(m_buffer[i])));
+        *destination = '-';
+        WriteDigits(destination + 1 + digits, magnitude);
+        return;
     }
+    char text[24];
+    text[0] = '-';
+    WriteDigits(text + 1 + digits, magnitude);
+    AppendChars(text, digits + 1);
 }
 
-bool StringUtility::IsEmpty() const
+// digits is CountDigits(value)
+void StringUtility::AppendUnsigned(unsigned long long value, int digits)
 {
-    return (m_length == 0);
+    char* destination = ExtendBy(digits);
+    if (destination != nullptr)
+    {
+        WriteDigits(destination + digits, value);
+        return;
+    }
+    char text[24];
+    WriteDigits(text + digits, value);
+    AppendChars(text, digits);
 }
 
+// Sets the capacity (terminator included) to newCapacity, never below the current length
+// Capacities that fit the inline buffer use it; everything else gets an exactly sized heap block
 void StringUtility::Resize(int newCapacity)
 {
-    if (newCapacity <= 0)
-        newCapacity = 16;
-    
-    char* newBuffer = new char[newCapacity];
-    newBuffer[0] = '\0';
-    
-    if (m_buffer != nullptr)
+    if (newCapacity < m_length + 1)
+        newCapacity = m_length + 1;
+
+    char* newBuffer = m_inlineBuffer;
+    if (newCapacity <= kInlineCapacity)
     {
-        if (m_length > 0)
-        {
-            #ifdef _WIN32
-            strcpy_s(newBuffer, newCapacity, m_buffer);
-            #else
-            strncpy(newBuffer, m_buffer, newCapacity - 1);
-            newBuffer[newCapacity - 1] = '\0';
-            #endif
-        }
-        delete[] m_buffer;
+        if (m_buffer == m_inlineBuffer)
+            return;
+        newCapacity = kInlineCapacity;
+    }
+    else
+    {
+        newBuffer = AllocateHeapBuffer(newCapacity, m_resource);
     }
     
+    memcpy(newBuffer, m_buffer, m_length + 1);
+    if (m_buffer != m_inlineBuffer)
+        ReleaseHeapBuffer(m_buffer);
+    
     m_buffer = newBuffer;
     m_capacity = newCapacity;
 }
 
+// Gives this object a private copy of a shared heap buffer before it is modified
+void StringUtility::MakeUnique()
+{
+    if (!IsShared())
+        return;
+    char* newBuffer = AllocateHeapBuffer(m_capacity, m_resource);
+    memcpy(newBuffer, m_buffer, m_length + 1);
+    ReleaseHeapBuffer(m_buffer);
+    m_buffer = newBuffer;
+}
+
+// Expects an empty inline object (fresh or after ReleaseBuffer); keeps this object's memory resource
+void StringUtility::CopyFrom(const StringUtility& other)
+{
+    m_copyOnWrite = other.m_copyOnWrite;
+    if (other.m_rope != nullptr)
+    {
+        // Shares the rope's tree; the flat copy is rebuilt on demand
+        m_rope = new Rope(*other.m_rope);
+        m_ropeFlat = false;
+    }
+    else if (other.m_buffer != other.m_inlineBuffer && other.m_copyOnWrite &&
+             GetHeapHeader(other.m_buffer)->resource == m_resource)
+    {
+        GetHeapHeader(other.m_buffer)->refCount.fetch_add(1, std::memory_order_relaxed);
+        m_buffer = other.m_buffer;
+        m_capacity = other.m_capacity;
+    }
+    else
+    {
+        Resize(other.m_length + 1);
+        memcpy(m_buffer, other.m_buffer, other.m_length + 1);
+    }
+    m_length = other.m_length;
+}
+
+// Expects an empty inline object; leaves other empty and inline
+void StringUtility::MoveFrom(StringUtility& other)
+{
+    m_copyOnWrite = other.m_copyOnWrite;
+    m_length = other.m_length;
+    if (other.m_rope != nullptr)
+    {
+        // The rope moves; the flat cache stays behind and is rebuilt on demand
+        m_rope = other.m_rope;
+        m_ropeFlat = false;
+        other.m_rope = nullptr;
+        other.ReleaseBuffer();
+    }
+    else if (other.m_buffer == other.m_inlineBuffer)
+    {
+        memcpy(m_inlineBuffer, other.m_inlineBuffer, other.m_length + 1);
+    }
+    else
+    {
+        m_buffer = other.m_buffer;
+        m_capacity = other.m_capacity;
+        other.m_buffer = other.m_inlineBuffer;
+        other.m_capacity = kInlineCapacity;
+    }
+    other.m_inlineBuffer[0] = '\0';
+    other.m_length = 0;
+}
+
+// Drops the heap buffer (or this object's share of it) and returns to an empty inline string
+// The rope, if any, is left to the caller
+void StringUtility::ReleaseBuffer()
+{
+    if (m_buffer != m_inlineBuffer)
+        ReleaseHeapBuffer(m_buffer);
+    m_buffer = m_inlineBuffer;
+    m_capacity = kInlineCapacity;
+    m_inlineBuffer[0] = '\0';
+    m_length = 0;
+}
+
 // ============================================================================
 // TextProcessor class implementation
 // ============================================================================
 
 TextProcessor::TextProcessor() : m_caseSensitive(true)
 {
-    std::cout << "[MyLibrary002] TextProcessor object created" << std::endl;
+    MYLIB_LOG_DEBUG("[MyLibrary002] TextProcessor object created");
 }
 
 TextProcessor::~TextProcessor()
 {
-    std::cout << "[MyLibrary002] TextProcessor object destroyed" << std::endl;
+    MYLIB_LOG_DEBUG("[MyLibrary002] TextProcessor object destroyed");
 }
 
-std::string TextProcessor::ProcessText(const std::string& input)
+// The std::string, output-buffer and std::pmr::string overloads share these bodies
+namespace
 {
-    std::string result = input;
-    // Remove leading and trailing whitespace
-    size_t start = result.find_first_not_of(" \t\n\r");
-    if (start != std::string::npos)
+    bool IsWordSpace(char c)
+    {
+        return std::isspace(static_cast<unsigned char>(c)) != 0;
+    }
+
+    template <typename String>
+    void TrimInto(std::string_view input, String& result)
+    {
+        std::string_view trimmed = TextKernels::Trim(input);
+        result.assign(trimmed.data(), trimmed.length());
+    }
+
+    template <typename String>
+    void RemoveWhitespaceInto(std::string_view input, String& result)
+    {
+        // Written through a pointer into the sized buffer, then cut back to what was kept
+        result.resize(input.length());
+        if (!input.empty())
+            result.resize(TextKernels::RemoveWhitespace(input.data(), &result[0], input.length()));
+    }
+
+    template <typename String>
+    void CapitalizeWordsInto(std::string_view input, String& result)
     {
-        result = result.substr(start);
+        result.resize(input.length());
+        if (!input.empty())
+            TextKernels::CapitalizeWords(input.data(), &result[0], input.length(), true);
     }
-    size_t end = result.find_last_not_of(" \t\n\r");
-    if (end != std::string::npos)
+
+    std::pmr::memory_resource* ResolveResource(std::pmr::memory_resource* resource)
     {
-        result = result.substr(0, end + 1);
+        return (resource != nullptr) ? resource : std::pmr::get_default_resource();
     }
+}
+
+std::string TextProcessor::ProcessText(std::string_view input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_PROCESS_TEXT);
+    std::string result;
+    TrimInto(input, result);
     return result;
 }
 
-std::string TextProcessor::RemoveWhitespace(const std::string& input)
+std::string TextProcessor::RemoveWhitespace(std::string_view input)
 {
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_REMOVE_WHITESPACE);
     std::string result;
-    result.reserve(input.length());
-    
-    for (char c : input)
+    RemoveWhitespaceInto(input, result);
+    return result;
+}
+
+std::string TextProcessor::CapitalizeWords(std::string_view input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_CAPITALIZE_WORDS);
+    std::string result;
+    CapitalizeWordsInto(input, result);
+    return result;
+}
+
+std::string_view TextProcessor::Trim(std::string_view input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_PROCESS_TEXT);
+    return TextKernels::Trim(input);
+}
+
+size_t TextProcessor::Split(std::string_view input, char delimiter, std::vector<std::string_view>& parts)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_SPLIT);
+    parts.clear();
+    if (input.empty())
+        return 0;
+
+    const char* begin = input.data();
+    const char* end = begin + input.length();
+    const char* found;
+    while ((found = static_cast<const char*>(memchr(begin, delimiter, end - begin))) != nullptr)
     {
-        if (!std::isspace(static_cast<unsigned char>(c)))
-        {
-            result += c;
-        }
+        parts.emplace_back(begin, found - begin);
+        begin = found + 1;
     }
-    
+    parts.emplace_back(begin, end - begin);
+    return parts.size();
+}
+
+void TextProcessor::ProcessText(std::string_view input, std::string& output)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_PROCESS_TEXT);
+    TrimInto(input, output);
+}
+
+void TextProcessor::RemoveWhitespace(std::string_view input, std::string& output)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_REMOVE_WHITESPACE);
+    RemoveWhitespaceInto(input, output);
+}
+
+void TextProcessor::CapitalizeWords(std::string_view input, std::string& output)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_CAPITALIZE_WORDS);
+    CapitalizeWordsInto(input, output);
+}
+
+std::pmr::string TextProcessor::ProcessText(std::string_view input, std::pmr::memory_resource* resource)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_PROCESS_TEXT);
+    std::pmr::string result(ResolveResource(resource));
+    TrimInto(input, result);
     return result;
 }
 
-std::string TextProcessor::CapitalizeWords(const std::string& input)
+std::pmr::string TextProcessor::RemoveWhitespace(std::string_view input, std::pmr::memory_resource* resource)
 {
-    std::string result = input;
-    bool newWord = true;
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_REMOVE_WHITESPACE);
+    std::pmr::string result(ResolveResource(resource));
+    RemoveWhitespaceInto(input, result);
+    return result;
+}
+
+std::pmr::string TextProcessor::CapitalizeWords(std::string_view input, std::pmr::memory_resource* resource)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_CAPITALIZE_WORDS);
+    std::pmr::string result(ResolveResource(resource));
+    CapitalizeWordsInto(input, result);
+    return result;
+}
+
+int TextProcessor::CountWords(std::string_view input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_COUNT_WORDS);
+    // A word starts at every non-space character that follows a space (or the start of the text),
+    // the same words stream extraction finds; the kernel counts them from whitespace bitmasks
+    bool inWord = false;
+    return static_cast<int>(TextKernels::CountWords(input.data(), input.length(), &inWord));
+}
+
+int TextProcessor::CountLines(std::string_view input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_COUNT_LINES);
+    if (input.empty())
+        return 0;
     
-    for (size_t i = 0; i < result.length(); i++)
+    // At least one line
+    return 1 + static_cast<int>(TextKernels::CountNewlines(input.data(), input.length()));
+}
+
+// The std::string and const char* overloads keep the original exports and literal calls; all forward to the views
+std::string TextProcessor::ProcessText(const std::string& input)
+{
+    return ProcessText(std::string_view(input));
+}
+
+std::string TextProcessor::RemoveWhitespace(const std::string& input)
+{
+    return RemoveWhitespace(std::string_view(input));
+}
+
+std::string TextProcessor::CapitalizeWords(const std::string& input)
+{
+    return CapitalizeWords(std::string_view(input));
+}
+
+int TextProcessor::CountWords(const std::string& input)
+{
+    return CountWords(std::string_view(input));
+}
+
+int TextProcessor::CountLines(const std::string& input)
+{
+    return CountLines(std::string_view(input));
+}
+
+std::string TextProcessor::ProcessText(const char* input)
+{
+    return ProcessText(std::string_view(input));
+}
+
+std::string TextProcessor::RemoveWhitespace(const char* input)
+{
+    return RemoveWhitespace(std::string_view(input));
+}
+
+std::string TextProcessor::CapitalizeWords(const char* input)
+{
+    return CapitalizeWords(std::string_view(input));
+}
+
+int TextProcessor::CountWords(const char* input)
+{
+    return CountWords(std::string_view(input));
+}
+
+int TextProcessor::CountLines(const char* input)
+{
+    return CountLines(std::string_view(input));
+}
+
+std::pmr::string TextProcessor::ProcessText(const std::string& input, std::pmr::memory_resource* resource)
+{
+    return ProcessText(std::string_view(input), resource);
+}
+
+std::pmr::string TextProcessor::RemoveWhitespace(const std::string& input, std::pmr::memory_resource* resource)
+{
+    return RemoveWhitespace(std::string_view(input), resource);
+}
+
+std::pmr::string TextProcessor::CapitalizeWords(const std::string& input, std::pmr::memory_resource* resource)
+{
+    return CapitalizeWords(std::string_view(input), resource);
+}
+
+std::pmr::string TextProcessor::ProcessText(const char* input, std::pmr::memory_resource* resource)
+{
+    return ProcessText(std::string_view(input), resource);
+}
+
+std::pmr::string TextProcessor::RemoveWhitespace(const char* input, std::pmr::memory_resource* resource)
+{
+    return RemoveWhitespace(std::string_view(input), resource);
+}
+
+std::pmr::string TextProcessor::CapitalizeWords(const char* input, std::pmr::memory_resource* resource)
+{
+    return CapitalizeWords(std::string_view(input), resource);
+}
+
+// ============================================================================
+// TextTokenizer class implementation
+// ============================================================================
+
+TextTokenizer::TextTokenizer(std::string_view text)
+    : m_position(text.data()), m_end(text.data() + text.length())
+{
+}
+
+bool TextTokenizer::Next(std::string_view* word)
+{
+    while (m_position != m_end && IsWordSpace(*m_position))
+        m_position++;
+    if (m_position == m_end)
+        return false;
+
+    const char* start = m_position;
+    while (m_position != m_end && !IsWordSpace(*m_position))
+        m_position++;
+    *word = std::string_view(start, m_position - start);
+    return true;
+}
+
+// Rope overloads: one pass over the chunks, carrying the word state across chunk boundaries
+// Transformed text is staged in a bounded block and appended to the result, which stays chunked too
+
+namespace
+{
+    const size_t kRopeStagingSize = 64 * 1024;
+
+    void FlushStaging(std::string& staging, Rope& result)
     {
-        if (std::isspace(static_cast<unsigned char>(result[i])))
-        {
-            newWord = true;
-        }
-        else if (newWord)
+        result.Append(staging.data(), staging.size());
+        staging.clear();
+    }
+}
+
+Rope TextProcessor::ProcessText(const Rope& input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_PROCESS_TEXT);
+    // Same trim set and all-whitespace behavior (returned unchanged) as the std::string version
+    size_t start = 0;
+    bool found = false;
+    RopeChunkIterator chunks(input);
+    const char* data = nullptr;
+    size_t length = 0;
+    while (!found && chunks.Next(&data, &length))
+    {
+        for (size_t i = 0; i < length; i++)
         {
-            result[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(result[i])));
-            newWord = false;
+            if (!TextKernels::IsTrimmedWhitespace(data[i]))
+            {
+                start += i;
+                found = true;
+                break;
+            }
         }
-        else
+        if (!found)
+            start += length;
+    }
+    if (!found)
+        return input;
+
+    size_t end = input.GetLength();
+    while (TextKernels::IsTrimmedWhitespace(input.CharAt(end - 1)))
+        end--;
+    return input.Substring(start, end - start);
+}
+
+Rope TextProcessor::RemoveWhitespace(const Rope& input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_REMOVE_WHITESPACE);
+    Rope result;
+    std::string staging;
+    staging.reserve(kRopeStagingSize);
+    RopeChunkIterator chunks(input);
+    const char* data = nullptr;
+    size_t length = 0;
+    while (chunks.Next(&data, &length))
+    {
+        for (size_t i = 0; i < length; i++)
         {
-            result[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(result[i])));
+            if (!IsWordSpace(data[i]))
+                staging += data[i];
         }
+        if (staging.size() >= kRopeStagingSize)
+            FlushStaging(staging, result);
     }
-    
+    FlushStaging(staging, result);
     return result;
 }
 
-int TextProcessor::CountWords(const std::string& input)
+Rope TextProcessor::CapitalizeWords(const Rope& input)
 {
-    if (input.empty())
-        return 0;
-    
-    std::istringstream iss(input);
-    std::string word;
-    int count = 0;
-    
-    while (iss >> word)
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_CAPITALIZE_WORDS);
+    Rope result;
+    std::string staging;
+    staging.reserve(kRopeStagingSize);
+    bool newWord = true;
+    RopeChunkIterator chunks(input);
+    const char* data = nullptr;
+    size_t length = 0;
+    while (chunks.Next(&data, &length))
     {
-        count++;
+        const size_t offset = staging.size();
+        staging.resize(offset + length);
+        newWord = TextKernels::CapitalizeWords(data, &staging[offset], length, newWord);
+        if (staging.size() >= kRopeStagingSize)
+            FlushStaging(staging, result);
     }
-    
-    return count;
+    FlushStaging(staging, result);
+    return result;
 }
 
-int TextProcessor::CountLines(const std::string& input)
+int TextProcessor::CountWords(const Rope& input)
 {
-    if (input.empty())
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_COUNT_WORDS);
+    size_t count = 0;
+    bool inWord = false;
+    RopeChunkIterator chunks(input);
+    const char* data = nullptr;
+    size_t length = 0;
+    while (chunks.Next(&data, &length))
+        count += TextKernels::CountWords(data, length, &inWord);
+    return static_cast<int>(count);
+}
+
+int TextProcessor::CountLines(const Rope& input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_COUNT_LINES);
+    if (input.IsEmpty())
         return 0;
-    
-    int count = 1; // At least one line
-    for (char c : input)
-    {
-        if (c == '\n')
-        {
-            count++;
-        }
-    }
-    
-    return count;
+
+    size_t count = 1; // At least one line
+    RopeChunkIterator chunks(input);
+    const char* data = nullptr;
+    size_t length = 0;
+    while (chunks.Next(&data, &length))
+        count += TextKernels::CountNewlines(data, length);
+    return static_cast<int>(count);
 }
 
 void TextProcessor::SetCaseSensitive(bool sensitive)
@@ -18,6 +18,45 @@
 #endif
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <memory_resource>
+// InstrumentationRecord, shared with MyLibrary
+#include "../Common/Instrumentation.h"
+
+// Memory held by a StringInterner, in bytes
+struct InternerStatistics
+{
+    unsigned long long stringCount;
+    unsigned long long stringBytes;      // Interned text including terminators
+    unsigned long long arenaBytes;       // Text storage reserved (stringBytes plus unused chunk tails)
+    unsigned long long tableBytes;       // Hash tables, including tables retired by growth
+    unsigned long long directoryBytes;   // Handle-to-string directory
+};
+
+// Output of one TextPipeline run, counted in the same pass
+struct TextPipelineStatistics
+{
+    long long outputBytes;
+    long long words;   // TextProcessor::CountWords of the output
+    long long lines;   // TextProcessor::CountLines of the output
+};
+
+// Totals of one TextStreamSession, as the TextProcessor methods would report them on the concatenated input
+struct TextStreamStatistics
+{
+    long long bytes;
+    long long words;   // TextProcessor::CountWords
+    long long lines;   // TextProcessor::CountLines
+};
+
+// Transformation applied to every fragment fed to a TextStreamSession
+enum TextStreamTransform
+{
+    TEXT_STREAM_COUNT_ONLY = 0,       // No output, statistics only
+    TEXT_STREAM_CAPITALIZE_WORDS = 1,
+    TEXT_STREAM_REMOVE_WHITESPACE = 2
+};
 
 // ============================================================================
 // C-style function exports
@@ -25,24 +64,178 @@
 
 extern "C" {
     // String manipulation functions
+    // Length, reverse and compare share the SIMD kernel level below; CompareStrings returns -1, 0 or 1
     MYLIBRARY002_API const char* GetLibraryName();
     MYLIBRARY002_API const char* GetLibraryVersion();
     MYLIBRARY002_API int GetStringLength(const char* str);
     MYLIBRARY002_API void ReverseString(char* str, int length);
     MYLIBRARY002_API int CompareStrings(const char* str1, const char* str2);
+
+    // Case conversion and CapitalizeWords run on SIMD kernels (AVX2/SSE2/table) selected once at runtime from CPUID
+    // They follow the C locale: only ASCII letters change case and bytes >= 0x80 pass through unchanged
+    MYLIBRARY002_API const char* GetTextKernelName();
+
+    // Process-wide string interning (GetStringInternerInstance): equal strings get equal 32-bit handles
+    // Handle 0 means "no string"; CompareInternedStrings compares equal handles in O(1) and others like CompareStrings
+    MYLIBRARY002_API unsigned int InternString(const char* str);
+    MYLIBRARY002_API const char* GetInternedString(unsigned int handle);
+    MYLIBRARY002_API int CompareInternedStrings(unsigned int handle1, unsigned int handle2);
+    MYLIBRARY002_API void GetInternerStatistics(InternerStatistics* stats);
+
+    // Opt-in call counters and latency histograms, same layout as MyLibrary's GetInstrumentationSnapshot
+    MYLIBRARY002_API void SetStringInstrumentationEnabled(int enabled);
+    MYLIBRARY002_API int GetStringInstrumentationSnapshot(InstrumentationRecord* records, int capacity);
 }
 
 // ============================================================================
 // C++ class exports
 // ============================================================================
 
+// ============================================================================
+// Memory resources (std::pmr) for StringUtility buffers and TextProcessor results
+// ============================================================================
+
+// Bump allocator for one request: allocation is a pointer increment, deallocate does nothing,
+// and Reset() releases everything at once while keeping the largest block for the next request
+// Not thread-safe; use one arena per request or per thread
+class MYLIBRARY002_API MonotonicArena : public std::pmr::memory_resource
+{
+public:
+    // upstream supplies the blocks; nullptr means std::pmr::new_delete_resource()
+    explicit MonotonicArena(size_t initialBlockSize = 64 * 1024, std::pmr::memory_resource* upstream = nullptr);
+    ~MonotonicArena();
+
+    void Reset();
+    size_t GetBytesUsed() const;      // Handed out since the last Reset
+    size_t GetBytesReserved() const;  // Held from upstream
+
+    struct Block;  // Opaque block header, defined in StringMemory.cpp
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* m_upstream;
+    Block* m_blocks;        // Newest (largest) first
+    char* m_current;
+    char* m_end;
+    size_t m_initialBlockSize;
+    size_t m_nextBlockSize;
+    size_t m_bytesUsed;
+    size_t m_bytesReserved;
+
+    MonotonicArena(const MonotonicArena&);
+    MonotonicArena& operator=(const MonotonicArena&);
+};
+
+// Process-wide thread-safe pool for long-lived strings: power-of-two size classes from 16 to 4096 bytes
+// Each thread keeps a small cache of free blocks per class and only locks the shared lists to refill or trim it
+// Larger or over-aligned requests go to the global heap. Pooled memory is reused, never returned to the heap.
+class MYLIBRARY002_API SizeClassPool : public std::pmr::memory_resource
+{
+public:
+    static SizeClassPool& Instance();
+
+    static const size_t kMaxPooledSize = 4096;
+    size_t GetBytesReserved() const;  // Slab memory taken from the heap
+
+    struct Central;  // Opaque shared free lists, defined in StringMemory.cpp
+
+private:
+    SizeClassPool();
+    ~SizeClassPool();
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    Central* m_central;
+
+    SizeClassPool(const SizeClassPool&);
+    SizeClassPool& operator=(const SizeClassPool&);
+};
+
+// Rope: a balanced tree of immutable text chunks for large documents that are spliced repeatedly
+// Insert, Erase, Substring and concatenation cost O(log n) instead of copying the text; copies share the tree
+// Chunks are never modified after creation, so a copy may be read on another thread while this one changes
+class MYLIBRARY002_API Rope
+{
+public:
+    Rope();
+    explicit Rope(const char* text);
+    Rope(const char* text, size_t length);
+    ~Rope();
+
+    // O(1): the tree is shared through per-node reference counts
+    Rope(const Rope& other);
+    Rope(Rope&& other) noexcept;
+    Rope& operator=(const Rope& other);
+    Rope& operator=(Rope&& other) noexcept;
+
+    size_t GetLength() const;
+    bool IsEmpty() const;
+    char CharAt(size_t position) const;  // '\0' past the end
+    int GetDepth() const;                 // Height of the tree, 0 for a single chunk
+
+    // Positions past the end are clamped to the end
+    void Append(const char* text, size_t length);
+    void Append(const Rope& other);
+    void Insert(size_t position, const char* text, size_t length);
+    void Insert(size_t position, const Rope& other);
+    void Erase(size_t position, size_t count);
+    void Clear();
+    Rope Substring(size_t position, size_t count) const;
+    static Rope Concat(const Rope& left, const Rope& right);
+
+    // Flattening, O(n)
+    std::string ToString() const;
+    void CopyTo(char* destination) const;  // Writes GetLength() characters, no terminator
+
+    struct Node;  // Opaque tree node, defined in Rope.cpp
+
+private:
+    friend class RopeChunkIterator;
+    explicit Rope(Node* root);
+
+    Node* m_root;   // nullptr for the empty rope
+};
+
+// Visits the chunks of a rope in order without flattening it
+// The rope must not be modified or destroyed while an iterator over it is in use
+//   RopeChunkIterator chunks(rope);
+//   const char* data; size_t length;
+//   while (chunks.Next(&data, &length)) { ... }
+class MYLIBRARY002_API RopeChunkIterator
+{
+public:
+    explicit RopeChunkIterator(const Rope& rope);
+
+    bool Next(const char** data, size_t* length);
+
+private:
+    static const int kMaxDepth = 96;  // Balanced trees stay far below this for any addressable length
+
+    const Rope::Node* m_stack[kMaxDepth];
+    int m_depth;
+};
+
 // String utility class
 class MYLIBRARY002_API StringUtility
 {
 public:
     StringUtility();
     explicit StringUtility(const char* initialValue);
+    // Heap buffers come from resource (an arena, the pool, ...); nullptr means the global heap
+    StringUtility(const char* initialValue, std::pmr::memory_resource* resource);
     ~StringUtility();
+
+    // Copies are deep unless the source is in copy-on-write mode; moves steal the heap buffer
+    // Like std::pmr containers, a copy uses the global heap and assignment keeps the target's resource
+    StringUtility(const StringUtility& other);
+    StringUtility(StringUtility&& other) noexcept;
+    StringUtility& operator=(const StringUtility& other);
+    StringUtility& operator=(StringUtility&& other) noexcept;
     
     // String operations
     void SetString(const char* str);
@@ -55,16 +248,102 @@ public:
     void ToUpperCase();
     void ToLowerCase();
     bool IsEmpty() const;
+    bool IsInline() const;  // true while the string fits the inline buffer (no heap allocation)
+
+    // Capacity management, in characters excluding the terminator
+    // Appends grow the buffer geometrically, so building a string piece by piece is amortized linear
+    void Reserve(int capacity);
+    int Capacity() const;
+    void ShrinkToFit();  // Releases unused heap capacity, moving back to the inline buffer when possible
+
+    // Copy-on-write mode: copies of this object share its heap buffer through an atomic reference count
+    // and the first modification of a shared buffer makes a private copy. Copies inherit the mode.
+    // Shared copies may be read from several threads; each object itself is still not thread-safe.
+    void EnableCopyOnWrite(bool enabled = true);
+    bool IsCopyOnWrite() const;
+    bool IsShared() const;  // true while the heap buffer is referenced by another StringUtility
+    std::pmr::memory_resource* GetMemoryResource() const;
+
+    // Numbers are written straight into the buffer without temporaries: integers two digits at a time,
+    // doubles in the shortest form that reads back to the same value ("0.1", "1e+100")
+    void AppendInt(long long value);
+    void AppendUInt(unsigned long long value);
+    void AppendDouble(double value);
+    // printf subset: %d %i %u %x %X (with l, ll or z), %f %e %g with an optional .precision (at most 64), %s %c %%
+    // No widths or flags; %g without a precision is the AppendDouble form; unknown conversions are copied as written
+    void AppendFormat(const char* format, ...);
+
+    // Splicing, positions clamped to the string
+    void Insert(int position, const char* str);
+    void Erase(int position, int count);
+
+    // Rope mode: the text lives in a Rope, so Insert, Erase and Append cost O(log n) on large documents
+    // GetString flattens into the buffer on first use after a change; GetRope gives chunked access without it
+    void EnableRopeMode(bool enabled = true);
+    bool IsRopeMode() const;
+    const Rope* GetRope() const;  // nullptr unless in rope mode
+
+    struct HeapHeader;  // Opaque reference count and owner in front of every heap buffer, defined in MyLibrary002.cpp
     
 private:
-    char* m_buffer;
+    // Strings up to 23 characters live inside the object; longer ones spill to a heap buffer
+    static const int kInlineCapacity = 24;
+
+    char* m_buffer;     // m_inlineBuffer or the characters of a heap block
     int m_capacity;
     int m_length;
+    bool m_copyOnWrite;
+    std::pmr::memory_resource* m_resource;  // Allocates new heap buffers; existing ones record their own
+    char m_inlineBuffer[kInlineCapacity];
+    Rope* m_rope;       // Rope mode only; m_length then tracks the rope and m_buffer is a cache
+    bool m_ropeFlat;    // m_buffer holds the current rope text
     
     void Resize(int newCapacity);
+    void Grow(int requiredCapacity);
+    void MakeUnique();
+    void CopyFrom(const StringUtility& other);
+    void MoveFrom(StringUtility& other);
+    void ReleaseBuffer();
+    void FlattenRope();
+    void AppendChars(const char* text, int length);
+    char* ExtendBy(int count);
+    void AppendSigned(long long value);
+    void AppendUnsigned(unsigned long long value, int digits);
+};
+
+// Thread-safe intern table: one 32-bit handle per unique string, so equality is a handle compare
+// Interned text is copied once into stable storage and stays valid for the interner's lifetime
+// Lookups (Find, GetString, and Intern of a known string) take no lock; new strings lock one of 64 stripes
+class MYLIBRARY002_API StringInterner
+{
+public:
+    StringInterner();
+    ~StringInterner();
+
+    static const unsigned int kInvalidHandle = 0;
+
+    unsigned int Intern(const char* str);                 // kInvalidHandle for nullptr
+    unsigned int Intern(const char* str, size_t length);  // str need not be terminated
+    unsigned int Find(const char* str) const;             // kInvalidHandle when not interned
+    unsigned int Find(const char* str, size_t length) const;
+
+    const char* GetString(unsigned int handle) const;     // nullptr for an unknown handle
+    size_t GetLength(unsigned int handle) const;
+    size_t GetCount() const;
+    void GetStatistics(InternerStatistics* stats) const;
+
+    struct Storage;  // Opaque stripes and handle directory, defined in StringInterner.cpp
+
+private:
+    Storage* m_storage;
+
+    StringInterner(const StringInterner&);
+    StringInterner& operator=(const StringInterner&);
 };
 
 // Text processor class
+// Methods taking std::string_view accept std::string, std::pmr::string, string literals and (pointer, length) pairs
+// without copying; returned views are slices of the input and live only as long as it does
 class MYLIBRARY002_API TextProcessor
 {
 public:
@@ -77,6 +356,47 @@ public:
     std::string CapitalizeWords(const std::string& input);
     int CountWords(const std::string& input);
     int CountLines(const std::string& input);
+
+    // View overloads for text that is not in a std::string, e.g. a (pointer, length) pair or a std::pmr::string
+    // The const char* overloads keep string literal calls unambiguous between the two
+    std::string ProcessText(std::string_view input);
+    std::string RemoveWhitespace(std::string_view input);
+    std::string CapitalizeWords(std::string_view input);
+    int CountWords(std::string_view input);
+    int CountLines(std::string_view input);
+    std::string ProcessText(const char* input);
+    std::string RemoveWhitespace(const char* input);
+    std::string CapitalizeWords(const char* input);
+    int CountWords(const char* input);
+    int CountLines(const char* input);
+
+    // Zero-copy slicing: ProcessText's trim as a view, and splitting into views (parts is cleared first, keeping its capacity)
+    // Split keeps empty fields, so n delimiters always give n + 1 parts; empty input gives none
+    std::string_view Trim(std::string_view input);
+    size_t Split(std::string_view input, char delimiter, std::vector<std::string_view>& parts);
+
+    // Results written to output, replacing its contents and reusing its capacity; output must not overlap input
+    void ProcessText(std::string_view input, std::string& output);
+    void RemoveWhitespace(std::string_view input, std::string& output);
+    void CapitalizeWords(std::string_view input, std::string& output);
+
+    // Results allocated from resource, e.g. a MonotonicArena released per request; nullptr means the default resource
+    std::pmr::string ProcessText(const std::string& input, std::pmr::memory_resource* resource);
+    std::pmr::string RemoveWhitespace(const std::string& input, std::pmr::memory_resource* resource);
+    std::pmr::string CapitalizeWords(const std::string& input, std::pmr::memory_resource* resource);
+    std::pmr::string ProcessText(std::string_view input, std::pmr::memory_resource* resource);
+    std::pmr::string RemoveWhitespace(std::string_view input, std::pmr::memory_resource* resource);
+    std::pmr::string CapitalizeWords(std::string_view input, std::pmr::memory_resource* resource);
+    std::pmr::string ProcessText(const char* input, std::pmr::memory_resource* resource);
+    std::pmr::string RemoveWhitespace(const char* input, std::pmr::memory_resource* resource);
+    std::pmr::string CapitalizeWords(const char* input, std::pmr::memory_resource* resource);
+
+    // Rope overloads, processed chunk by chunk without flattening; results match the string versions
+    Rope ProcessText(const Rope& input);
+    Rope RemoveWhitespace(const Rope& input);
+    Rope CapitalizeWords(const Rope& input);
+    int CountWords(const Rope& input);
+    int CountLines(const Rope& input);
     
     // Configuration
     void SetCaseSensitive(bool sensitive);
@@ -86,12 +406,159 @@ private:
     bool m_caseSensitive;
 };
 
+// Visits the whitespace-separated words of a text as views into it, in order, with no allocation
+// Words are the ones CountWords counts; the text must outlive the tokenizer and the views it returns
+//   TextTokenizer words(text);
+//   std::string_view word;
+//   while (words.Next(&word)) { ... }
+class MYLIBRARY002_API TextTokenizer
+{
+public:
+    explicit TextTokenizer(std::string_view text);
+
+    bool Next(std::string_view* word);
+
+private:
+    const char* m_position;
+    const char* m_end;
+};
+
+// Runs the TextProcessor operations over memory-mapped text files, one window at a time
+// Only one window is mapped at a time (sequential access hint) and outputs are written through one window-sized
+// buffer, so peak memory depends on the window size, not the file size. Word and line state is carried across
+// window edges, so results equal the TextProcessor methods on the whole file read into a string
+class MYLIBRARY002_API TextFileProcessor
+{
+public:
+    TextFileProcessor();
+    ~TextFileProcessor();
+
+    void SetWindowSize(long long bytes);  // Default 16 MB, rounded up to the mapping granularity
+    long long GetWindowSize() const;
+
+    // false if the file cannot be opened or mapped; the counts are 64-bit because the files may be
+    bool CountLines(const char* path, long long* lines);
+    bool CountWords(const char* path, long long* words);
+
+    // Write the transformed text of path to outPath, which must be a different file; false on any I/O failure
+    bool RemoveWhitespace(const char* path, const char* outPath);
+    bool CapitalizeWords(const char* path, const char* outPath);
+
+private:
+    long long m_windowSize;
+};
+
+// TextProcessor operations split across threads for large inputs; results are identical to the sequential methods
+// The input is cut into one chunk per thread (each at least the minimum chunk size) and the partial results are merged:
+// word counts by the in-word state at each chunk edge, RemoveWhitespace output by prefix sums of the per-chunk sizes
+// Inputs shorter than two minimum chunks run on the calling thread. One call runs at a time per object.
+class MYLIBRARY002_API ParallelTextProcessor
+{
+public:
+    explicit ParallelTextProcessor(int threadCount = 0);  // 0 = one thread per hardware thread (caller included)
+    ~ParallelTextProcessor();
+
+    void SetMinChunkSize(long long bytes);  // Default 1 MB
+    long long GetMinChunkSize() const;
+    int GetThreadCount() const;
+
+    long long CountWords(std::string_view input);
+    long long CountLines(std::string_view input);
+    std::string RemoveWhitespace(std::string_view input);
+    std::string CapitalizeWords(std::string_view input);
+
+    // Results written to output, replacing its contents and reusing its capacity; output must not overlap input
+    void RemoveWhitespace(std::string_view input, std::string& output);
+    void CapitalizeWords(std::string_view input, std::string& output);
+
+    class ChunkPool;  // Opaque, defined in ParallelTextProcessor.cpp
+
+private:
+    ChunkPool* m_pool;
+    long long m_minChunkSize;
+
+    ParallelTextProcessor(const ParallelTextProcessor&);
+    ParallelTextProcessor& operator=(const ParallelTextProcessor&);
+};
+
+// Chains TextProcessor stages into one pass over the input with a single output buffer
+// Stages are only recorded when added. The first Run after a change compiles them into a plan, which is cached:
+// redundant stages are dropped (a trim before or after RemoveWhitespace, repeated stages, a CapitalizeWords that a
+// later one overrides) and the rest run block by block on cache-sized pieces of the input, so N stages cost about
+// one pass. Output equals calling the TextProcessor methods in the same order. Not thread-safe; use one per thread.
+//   TextPipeline pipeline;
+//   pipeline.ProcessText().RemoveWhitespace().CapitalizeWords();
+//   pipeline.Run(input, output, &stats);
+class MYLIBRARY002_API TextPipeline
+{
+public:
+    TextPipeline();
+    ~TextPipeline();
+
+    TextPipeline& ProcessText();  // Trim, as TextProcessor::ProcessText
+    TextPipeline& RemoveWhitespace();
+    TextPipeline& CapitalizeWords();
+    void Clear();
+
+    int GetStageCount() const;
+    int GetPlanStepCount();  // Steps left after compiling; compiles the plan if needed
+
+    // output is replaced, reusing its capacity, and must not overlap input; stats (optional) describe the output
+    void Run(std::string_view input, std::string& output, TextPipelineStatistics* stats = nullptr);
+    std::string Run(std::string_view input);
+
+    struct Plan;  // Opaque stage list and compiled plan, defined in TextPipeline.cpp
+
+private:
+    Plan* m_plan;
+
+    TextPipeline(const TextPipeline&);
+    TextPipeline& operator=(const TextPipeline&);
+};
+
+// Incremental TextProcessor over text that arrives in fragments (network reads, pipes, ...)
+// Only the word state of the last byte and the running counts are kept between fragments, so memory is O(fragment)
+// and each Feed costs time proportional to its own fragment. Words and capitalization continue across fragment
+// edges: the concatenated outputs and the Finish statistics equal the TextProcessor methods on the whole text.
+//   TextStreamSession session(TEXT_STREAM_CAPITALIZE_WORDS);
+//   while (receive(&data, &length))
+//       send(session.Feed(data, length));
+//   session.Finish(&stats);
+class MYLIBRARY002_API TextStreamSession
+{
+public:
+    explicit TextStreamSession(TextStreamTransform transform = TEXT_STREAM_COUNT_ONLY);
+    ~TextStreamSession();
+
+    // Returns the transformed fragment (empty for TEXT_STREAM_COUNT_ONLY), valid until the next Feed or destruction
+    std::string_view Feed(const char* data, size_t length);
+    // Reports the totals and starts a new stream with the same transform
+    void Finish(TextStreamStatistics* stats);
+    void Reset();
+
+    TextStreamTransform GetTransform() const;
+    long long GetBytesFed() const;  // Since the last Finish or Reset
+
+private:
+    TextStreamTransform m_transform;
+    bool m_inWord;          // The last byte fed was not whitespace
+    unsigned long long m_bytes;
+    unsigned long long m_words;
+    unsigned long long m_newlines;
+    char* m_output;         // Reused for every fragment, grown to the largest one
+    size_t m_outputCapacity;
+
+    TextStreamSession(const TextStreamSession&);
+    TextStreamSession& operator=(const TextStreamSession&);
+};
+
 // ============================================================================
 // Singleton function export (similar to VerificationSystemInstance)
 // ============================================================================
 
 MYLIBRARY002_API StringUtility& GetStringUtilityInstance();
 MYLIBRARY002_API TextProcessor& GetTextProcessorInstance();
+MYLIBRARY002_API StringInterner& GetStringInternerInstance();
 
 #endif // MYLIBRARY002_H
 
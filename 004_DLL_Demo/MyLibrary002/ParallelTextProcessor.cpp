@@ -0,0 +1,308 @@
+//*******************************************************************************************************************
+//**  ParallelTextProcessor.cpp - Multi-Threaded TextProcessor Operations
+//**  Per-thread chunks on a persistent pool, merged by edge word state (counts) or prefix offsets (RemoveWhitespace)
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "MyLibrary002.h"
+#include "StringInstrumentation.h"
+#include "TextKernels.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const long long kDefaultMinChunkSize = 1024 * 1024;
+
+    // Half-open byte range of one chunk
+    struct ChunkRange
+    {
+        size_t first;
+        size_t last;
+    };
+
+    // One chunk per thread, each at least minChunkSize bytes; a single chunk means "run on the caller"
+    std::vector<ChunkRange> SplitChunks(size_t length, int threadCount, long long minChunkSize)
+    {
+        size_t chunkCount = length / static_cast<size_t>(minChunkSize);
+        if (chunkCount > static_cast<size_t>(threadCount))
+            chunkCount = static_cast<size_t>(threadCount);
+        if (chunkCount < 1)
+            chunkCount = 1;
+
+        std::vector<ChunkRange> chunks(chunkCount);
+        for (size_t i = 0; i < chunkCount; i++)
+        {
+            chunks[i].first = length / chunkCount * i + (i < length % chunkCount ? i : length % chunkCount);
+            chunks[i].last = chunks[i].first + length / chunkCount + (i < length % chunkCount ? 1 : 0);
+        }
+        return chunks;
+    }
+}
+
+// ============================================================================
+// Chunk pool
+// ============================================================================
+// The caller is one of the threads and the pool owns threadCount - 1 background workers.
+// Run() publishes a task under a new generation; every thread claims chunk indices from a shared counter
+// until none are left, and Run() returns once no worker is still inside the task.
+
+class ParallelTextProcessor::ChunkPool
+{
+public:
+    explicit ChunkPool(int threadCount)
+        : m_task(nullptr), m_generation(0), m_chunkCount(0), m_nextChunk(0), m_busyWorkers(0), m_stopping(false)
+    {
+        for (int i = 1; i < threadCount; i++)
+            m_threads.emplace_back(&ChunkPool::WorkerLoop, this);
+    }
+
+    ~ChunkPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stopping = true;
+        }
+        m_wakeCondition.notify_all();
+        for (std::thread& thread : m_threads)
+            thread.join();
+    }
+
+    int GetThreadCount() const
+    {
+        return static_cast<int>(m_threads.size()) + 1;
+    }
+
+    // Calls task(chunk) exactly once for every chunk in [0, chunkCount), in parallel; returns when all are done
+    void Run(int chunkCount, const std::function<void(int)>& task)
+    {
+        std::lock_guard<std::mutex> runGuard(m_runLock);
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_task = &task;
+            m_chunkCount = chunkCount;
+            m_nextChunk.store(0, std::memory_order_relaxed);
+            m_generation++;
+        }
+        m_wakeCondition.notify_all();
+
+        ProcessChunks(task);
+
+        // Workers that have not picked the task up yet find it gone and go back to sleep
+        std::unique_lock<std::mutex> guard(m_lock);
+        m_task = nullptr;
+        m_doneCondition.wait(guard, [this]() { return m_busyWorkers == 0; });
+    }
+
+private:
+    void ProcessChunks(const std::function<void(int)>& task)
+    {
+        for (int chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < m_chunkCount;
+             chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed))
+        {
+            task(chunk);
+        }
+    }
+
+    void WorkerLoop()
+    {
+        unsigned long long seen = 0;
+        for (;;)
+        {
+            const std::function<void(int)>* task = nullptr;
+            {
+                std::unique_lock<std::mutex> guard(m_lock);
+                m_wakeCondition.wait(guard, [&]() { return m_stopping || m_generation != seen; });
+                if (m_stopping)
+                    return;
+                seen = m_generation;
+                task = m_task;
+                if (task == nullptr)
+                    continue;
+                m_busyWorkers++;
+            }
+
+            ProcessChunks(*task);
+
+            std::lock_guard<std::mutex> guard(m_lock);
+            if (--m_busyWorkers == 0)
+                m_doneCondition.notify_all();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_runLock;
+
+    std::mutex m_lock;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+    const std::function<void(int)>* m_task;
+    unsigned long long m_generation;
+    int m_chunkCount;
+    std::atomic<int> m_nextChunk;
+    int m_busyWorkers;
+    bool m_stopping;
+};
+
+// ============================================================================
+// ParallelTextProcessor class implementation
+// ============================================================================
+
+ParallelTextProcessor::ParallelTextProcessor(int threadCount)
+    : m_pool(nullptr), m_minChunkSize(kDefaultMinChunkSize)
+{
+    if (threadCount <= 0)
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount <= 0)
+        threadCount = 1;
+    m_pool = new ChunkPool(threadCount);
+}
+
+ParallelTextProcessor::~ParallelTextProcessor()
+{
+    delete m_pool;
+}
+
+void ParallelTextProcessor::SetMinChunkSize(long long bytes)
+{
+    m_minChunkSize = (bytes > 0) ? bytes : kDefaultMinChunkSize;
+}
+
+long long ParallelTextProcessor::GetMinChunkSize() const
+{
+    return m_minChunkSize;
+}
+
+int ParallelTextProcessor::GetThreadCount() const
+{
+    return m_pool->GetThreadCount();
+}
+
+long long ParallelTextProcessor::CountWords(std::string_view input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_PARALLEL_TEXT_COUNT_WORDS);
+    const char* data = input.data();
+    std::vector<ChunkRange> chunks = SplitChunks(input.length(), GetThreadCount(), m_minChunkSize);
+
+    // Every chunk counts as if it started after a space and records whether it ends inside a word.
+    // A chunk whose first byte continues the previous chunk's last word counted that word once too often.
+    struct WordState
+    {
+        size_t count;
+        bool endsInWord;
+    };
+    std::vector<WordState> states(chunks.size());
+    auto countChunk = [&](int chunk) {
+        bool inWord = false;
+        states[chunk].count = TextKernels::CountWords(data + chunks[chunk].first, chunks[chunk].last - chunks[chunk].first, &inWord);
+        states[chunk].endsInWord = inWord;
+    };
+    if (chunks.size() == 1)
+        countChunk(0);
+    else
+        m_pool->Run(static_cast<int>(chunks.size()), countChunk);
+
+    unsigned long long count = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        count += states[i].count;
+        if (i > 0 && states[i - 1].endsInWord && chunks[i].first < chunks[i].last && !TextKernels::IsWhitespace(data[chunks[i].first]))
+            count--;
+    }
+    return static_cast<long long>(count);
+}
+
+long long ParallelTextProcessor::CountLines(std::string_view input)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_PARALLEL_TEXT_COUNT_LINES);
+    if (input.empty())
+        return 0;
+
+    const char* data = input.data();
+    std::vector<ChunkRange> chunks = SplitChunks(input.length(), GetThreadCount(), m_minChunkSize);
+    std::vector<size_t> newlines(chunks.size());
+    auto countChunk = [&](int chunk) {
+        newlines[chunk] = TextKernels::CountNewlines(data + chunks[chunk].first, chunks[chunk].last - chunks[chunk].first);
+    };
+    if (chunks.size() == 1)
+        countChunk(0);
+    else
+        m_pool->Run(static_cast<int>(chunks.size()), countChunk);
+
+    unsigned long long count = 1; // At least one line
+    for (size_t n : newlines)
+        count += n;
+    return static_cast<long long>(count);
+}
+
+std::string ParallelTextProcessor::RemoveWhitespace(std::string_view input)
+{
+    std::string result;
+    RemoveWhitespace(input, result);
+    return result;
+}
+
+std::string ParallelTextProcessor::CapitalizeWords(std::string_view input)
+{
+    std::string result;
+    CapitalizeWords(input, result);
+    return result;
+}
+
+void ParallelTextProcessor::RemoveWhitespace(std::string_view input, std::string& output)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_PARALLEL_TEXT_REMOVE_WHITESPACE);
+    const char* data = input.data();
+    std::vector<ChunkRange> chunks = SplitChunks(input.length(), GetThreadCount(), m_minChunkSize);
+    if (chunks.size() == 1)
+    {
+        output.resize(input.length());
+        if (!input.empty())
+            output.resize(TextKernels::RemoveWhitespace(data, &output[0], input.length()));
+        return;
+    }
+
+    // First pass: kept bytes per chunk. Their prefix sums are where each chunk's output starts,
+    // so the second pass compacts every chunk straight into its place in the result
+    std::vector<size_t> offsets(chunks.size() + 1, 0);
+    m_pool->Run(static_cast<int>(chunks.size()), [&](int chunk) {
+        offsets[chunk + 1] = TextKernels::CountNonWhitespace(data + chunks[chunk].first, chunks[chunk].last - chunks[chunk].first);
+    });
+    for (size_t i = 1; i < offsets.size(); i++)
+        offsets[i] += offsets[i - 1];
+
+    output.resize(offsets.back());
+    if (output.empty())
+        return;
+    char* out = &output[0];
+    m_pool->Run(static_cast<int>(chunks.size()), [&](int chunk) {
+        // The kernel writes only the bytes it keeps, so neighbouring chunks never touch each other's output
+        TextKernels::RemoveWhitespace(data + chunks[chunk].first, out + offsets[chunk], chunks[chunk].last - chunks[chunk].first);
+    });
+}
+
+void ParallelTextProcessor::CapitalizeWords(std::string_view input, std::string& output)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_PARALLEL_TEXT_CAPITALIZE_WORDS);
+    output.resize(input.length());
+    if (input.empty())
+        return;
+
+    // Each chunk starts from the state after the byte in front of it, which is part of the input
+    const char* data = input.data();
+    char* out = &output[0];
+    std::vector<ChunkRange> chunks = SplitChunks(input.length(), GetThreadCount(), m_minChunkSize);
+    auto capitalizeChunk = [&](int chunk) {
+        const size_t first = chunks[chunk].first;
+        bool newWord = (first == 0) || TextKernels::IsWhitespace(data[first - 1]);
+        TextKernels::CapitalizeWords(data + first, out + first, chunks[chunk].last - first, newWord);
+    };
+    if (chunks.size() == 1)
+        capitalizeChunk(0);
+    else
+        m_pool->Run(static_cast<int>(chunks.size()), capitalizeChunk);
+}
@@ -0,0 +1,443 @@
+//*******************************************************************************************************************
+//**  Rope.cpp - Balanced Chunk Tree for Large Text (Rope, RopeChunkIterator)
+//**  AVL-balanced concatenation tree over immutable leaf chunks; every edit is a split and a join
+//**  Nodes are reference counted and never modified once built, so edits copy only the O(log n) path they touch
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "MyLibrary002.h"
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+// Leaves hold text and have height 0; branches hold two non-empty children
+struct Rope::Node
+{
+    std::atomic<int> refCount;
+    int height;
+    size_t length;
+    Node* left;
+    Node* right;
+    std::string text;
+
+    Node() : refCount(1), height(0), length(0), left(nullptr), right(nullptr) {}
+};
+
+namespace
+{
+    typedef Rope::Node Node;
+
+    const size_t kLeafSize = 1024;  // Text is cut into chunks of this size; adjacent small chunks merge up to it
+
+    void Retain(Node* node)
+    {
+        if (node != nullptr)
+            node->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Release(Node* node)
+    {
+        if (node != nullptr && node->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Release(node->left);
+            Release(node->right);
+            delete node;
+        }
+    }
+
+    // Owning handle used while rebuilding paths, so early returns cannot leak a reference
+    class NodeRef
+    {
+    public:
+        NodeRef() : m_node(nullptr) {}
+        explicit NodeRef(Node* adopted) : m_node(adopted) {}
+        NodeRef(const NodeRef& other) : m_node(other.m_node) { Retain(m_node); }
+        NodeRef(NodeRef&& other) noexcept : m_node(other.m_node) { other.m_node = nullptr; }
+        ~NodeRef() { Release(m_node); }
+
+        NodeRef& operator=(NodeRef other)
+        {
+            std::swap(m_node, other.m_node);
+            return *this;
+        }
+
+        // Borrowed child of a live node
+        static NodeRef Share(Node* node)
+        {
+            Retain(node);
+            return NodeRef(node);
+        }
+
+        Node* Get() const { return m_node; }
+        Node* operator->() const { return m_node; }
+        explicit operator bool() const { return m_node != nullptr; }
+
+        Node* Detach()
+        {
+            Node* node = m_node;
+            m_node = nullptr;
+            return node;
+        }
+
+    private:
+        Node* m_node;
+    };
+
+    int Height(const NodeRef& node)
+    {
+        return node ? node->height : -1;
+    }
+
+    size_t Length(Node* node)
+    {
+        return (node != nullptr) ? node->length : 0;
+    }
+
+    NodeRef MakeLeaf(const char* text, size_t length)
+    {
+        if (length == 0)
+            return NodeRef();
+        Node* node = new Node();
+        node->text.assign(text, length);
+        node->length = length;
+        return NodeRef(node);
+    }
+
+    NodeRef MakeBranch(NodeRef left, NodeRef right)
+    {
+        Node* node = new Node();
+        node->height = 1 + ((left->height > right->height) ? left->height : right->height);
+        node->length = left->length + right->length;
+        node->left = left.Detach();
+        node->right = right.Detach();
+        return NodeRef(node);
+    }
+
+    // Builds a branch from subtrees whose heights differ by at most 2, rotating once or twice to restore balance
+    NodeRef Balance(NodeRef left, NodeRef right)
+    {
+        if (Height(left) > Height(right) + 1)
+        {
+            NodeRef outer = NodeRef::Share(left->left);
+            NodeRef inner = NodeRef::Share(left->right);
+            if (Height(outer) >= Height(inner))
+                return MakeBranch(outer, MakeBranch(inner, std::move(right)));
+            return MakeBranch(MakeBranch(outer, NodeRef::Share(inner->left)),
+                              MakeBranch(NodeRef::Share(inner->right), std::move(right)));
+        }
+        if (Height(right) > Height(left) + 1)
+        {
+            NodeRef outer = NodeRef::Share(right->right);
+            NodeRef inner = NodeRef::Share(right->left);
+            if (Height(outer) >= Height(inner))
+                return MakeBranch(MakeBranch(std::move(left), inner), outer);
+            return MakeBranch(MakeBranch(std::move(left), NodeRef::Share(inner->left)),
+                              MakeBranch(NodeRef::Share(inner->right), outer));
+        }
+        return MakeBranch(std::move(left), std::move(right));
+    }
+
+    // Concatenation: descends the taller tree's inner spine to a subtree of matching height, O(|h1 - h2| + 1)
+    NodeRef Join(NodeRef left, NodeRef right)
+    {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+        if (left->height == 0 && right->height == 0 && left->length + right->length <= kLeafSize)
+        {
+            std::string text;
+            text.reserve(left->length + right->length);
+            text.append(left->text).append(right->text);
+            return MakeLeaf(text.data(), text.size());
+        }
+        if (Height(left) > Height(right) + 1)
+            return Balance(NodeRef::Share(left->left), Join(NodeRef::Share(left->right), std::move(right)));
+        if (Height(right) > Height(left) + 1)
+            return Balance(Join(std::move(left), NodeRef::Share(right->left)), NodeRef::Share(right->right));
+        return MakeBranch(std::move(left), std::move(right));
+    }
+
+    // [0, position) and [position, length), sharing every subtree the cut does not cross
+    std::pair<NodeRef, NodeRef> Split(const NodeRef& node, size_t position)
+    {
+        if (!node || position == 0)
+            return std::make_pair(NodeRef(), node);
+        if (position >= node->length)
+            return std::make_pair(node, NodeRef());
+        if (node->height == 0)
+        {
+            const char* text = node->text.data();
+            return std::make_pair(MakeLeaf(text, position), MakeLeaf(text + position, node->length - position));
+        }
+
+        const size_t leftLength = node->left->length;
+        if (position == leftLength)
+            return std::make_pair(NodeRef::Share(node->left), NodeRef::Share(node->right));
+        if (position < leftLength)
+        {
+            std::pair<NodeRef, NodeRef> parts = Split(NodeRef::Share(node->left), position);
+            return std::make_pair(std::move(parts.first), Join(std::move(parts.second), NodeRef::Share(node->right)));
+        }
+        std::pair<NodeRef, NodeRef> parts = Split(NodeRef::Share(node->right), position - leftLength);
+        return std::make_pair(Join(NodeRef::Share(node->left), std::move(parts.first)), std::move(parts.second));
+    }
+
+    // Perfectly balanced tree over full-size chunks of a long text
+    NodeRef Build(const char* text, size_t chunkCount, size_t length)
+    {
+        if (chunkCount <= 1)
+            return MakeLeaf(text, length);
+        size_t leftChunks = chunkCount / 2;
+        size_t leftLength = leftChunks * kLeafSize;
+        return MakeBranch(Build(text, leftChunks, leftLength),
+                          Build(text + leftLength, chunkCount - leftChunks, length - leftLength));
+    }
+
+    NodeRef Build(const char* text, size_t length)
+    {
+        if (text == nullptr || length == 0)
+            return NodeRef();
+        return Build(text, (length + kLeafSize - 1) / kLeafSize, length);
+    }
+
+    // Small appends extend the last chunk in place of adding a leaf; copies the right spine, heights unchanged
+    // Returns an empty ref when the last chunk has no room
+    NodeRef AppendToLastChunk(Node* node, const char* text, size_t length)
+    {
+        if (node->height == 0)
+        {
+            if (node->length + length > kLeafSize)
+                return NodeRef();
+            Node* leaf = new Node();
+            leaf->text.reserve(node->length + length);
+            leaf->text.append(node->text).append(text, length);
+            leaf->length = leaf->text.size();
+            return NodeRef(leaf);
+        }
+        NodeRef right = AppendToLastChunk(node->right, text, length);
+        if (!right)
+            return NodeRef();
+        return MakeBranch(NodeRef::Share(node->left), std::move(right));
+    }
+}
+
+// ============================================================================
+// Rope class implementation
+// ============================================================================
+
+Rope::Rope() : m_root(nullptr)
+{
+}
+
+Rope::Rope(const char* text) : m_root(nullptr)
+{
+    if (text != nullptr)
+        m_root = Build(text, strlen(text)).Detach();
+}
+
+Rope::Rope(const char* text, size_t length) : m_root(Build(text, length).Detach())
+{
+}
+
+Rope::Rope(Node* root) : m_root(root)
+{
+}
+
+Rope::~Rope()
+{
+    Release(m_root);
+}
+
+Rope::Rope(const Rope& other) : m_root(other.m_root)
+{
+    Retain(m_root);
+}
+
+Rope::Rope(Rope&& other) noexcept : m_root(other.m_root)
+{
+    other.m_root = nullptr;
+}
+
+Rope& Rope::operator=(const Rope& other)
+{
+    Retain(other.m_root);
+    Release(m_root);
+    m_root = other.m_root;
+    return *this;
+}
+
+Rope& Rope::operator=(Rope&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release(m_root);
+        m_root = other.m_root;
+        other.m_root = nullptr;
+    }
+    return *this;
+}
+
+size_t Rope::GetLength() const
+{
+    return Length(m_root);
+}
+
+bool Rope::IsEmpty() const
+{
+    return m_root == nullptr;
+}
+
+char Rope::CharAt(size_t position) const
+{
+    const Node* node = m_root;
+    if (node == nullptr || position >= node->length)
+        return '\0';
+    while (node->height > 0)
+    {
+        if (position < node->left->length)
+        {
+            node = node->left;
+        }
+        else
+        {
+            position -= node->left->length;
+            node = node->right;
+        }
+    }
+    return node->text[position];
+}
+
+int Rope::GetDepth() const
+{
+    return (m_root != nullptr) ? m_root->height : 0;
+}
+
+void Rope::Append(const char* text, size_t length)
+{
+    if (text == nullptr || length == 0)
+        return;
+    if (m_root != nullptr)
+    {
+        NodeRef extended = AppendToLastChunk(m_root, text, length);
+        if (extended)
+        {
+            Release(m_root);
+            m_root = extended.Detach();
+            return;
+        }
+    }
+    NodeRef root(m_root);
+    m_root = nullptr;
+    m_root = Join(std::move(root), Build(text, length)).Detach();
+}
+
+void Rope::Append(const Rope& other)
+{
+    // other may be *this; the share is taken before m_root is handed to Join
+    NodeRef right = NodeRef::Share(other.m_root);
+    NodeRef root(m_root);
+    m_root = nullptr;
+    m_root = Join(std::move(root), std::move(right)).Detach();
+}
+
+void Rope::Insert(size_t position, const char* text, size_t length)
+{
+    if (text == nullptr || length == 0)
+        return;
+    Insert(position, Rope(text, length));
+}
+
+void Rope::Insert(size_t position, const Rope& other)
+{
+    NodeRef middle = NodeRef::Share(other.m_root);
+    NodeRef root(m_root);
+    m_root = nullptr;
+    std::pair<NodeRef, NodeRef> parts = Split(root, position);
+    m_root = Join(Join(std::move(parts.first), std::move(middle)), std::move(parts.second)).Detach();
+}
+
+void Rope::Erase(size_t position, size_t count)
+{
+    const size_t length = GetLength();
+    if (position >= length || count == 0)
+        return;
+    if (count > length - position)
+        count = length - position;
+
+    NodeRef root(m_root);
+    m_root = nullptr;
+    std::pair<NodeRef, NodeRef> head = Split(root, position);
+    std::pair<NodeRef, NodeRef> tail = Split(head.second, count);
+    m_root = Join(std::move(head.first), std::move(tail.second)).Detach();
+}
+
+void Rope::Clear()
+{
+    Release(m_root);
+    m_root = nullptr;
+}
+
+Rope Rope::Substring(size_t position, size_t count) const
+{
+    const size_t length = GetLength();
+    if (position >= length || count == 0)
+        return Rope();
+    if (count > length - position)
+        count = length - position;
+
+    std::pair<NodeRef, NodeRef> head = Split(NodeRef::Share(m_root), position);
+    std::pair<NodeRef, NodeRef> tail = Split(head.second, count);
+    return Rope(tail.first.Detach());
+}
+
+Rope Rope::Concat(const Rope& left, const Rope& right)
+{
+    return Rope(Join(NodeRef::Share(left.m_root), NodeRef::Share(right.m_root)).Detach());
+}
+
+std::string Rope::ToString() const
+{
+    std::string result(GetLength(), '\0');
+    if (!result.empty())
+        CopyTo(&result[0]);
+    return result;
+}
+
+void Rope::CopyTo(char* destination) const
+{
+    RopeChunkIterator chunks(*this);
+    const char* data = nullptr;
+    size_t length = 0;
+    while (chunks.Next(&data, &length))
+    {
+        memcpy(destination, data, length);
+        destination += length;
+    }
+}
+
+// ============================================================================
+// RopeChunkIterator class implementation
+// ============================================================================
+// The stack holds the subtrees still to visit, deepest-left first; it never exceeds the tree height + 1
+
+RopeChunkIterator::RopeChunkIterator(const Rope& rope) : m_depth(0)
+{
+    if (rope.m_root != nullptr)
+        m_stack[m_depth++] = rope.m_root;
+}
+
+bool RopeChunkIterator::Next(const char** data, size_t* length)
+{
+    if (m_depth == 0)
+        return false;
+    const Rope::Node* node = m_stack[--m_depth];
+    while (node->height > 0)
+    {
+        m_stack[m_depth++] = node->right;
+        node = node->left;
+    }
+    *data = node->text.data();
+    *length = node->length;
+    return true;
+}
@@ -0,0 +1,88 @@
+//*******************************************************************************************************************
+//**  StringInstrumentation.h - Instrumented Function Table for MyLibrary002 (internal header)
+//**  Function ids and names reported by GetStringInstrumentationSnapshot, in snapshot order
+//********************************************************************************************************************
+
+#pragma once
+#ifndef STRINGINSTRUMENTATION_H
+#define STRINGINSTRUMENTATION_H
+
+#include "../Common/Instrumentation.h"
+
+// Trivial accessors (GetLibraryName, GetString, GetLength, ...) are not instrumented
+// Rope, output-buffer and std::pmr::string overloads of the TextProcessor methods share the id of their std::string version
+// TextProcessor::Trim counts as ProcessText
+// The numeric and formatted appends count as StringUtility::Append
+enum StringLibraryFunction
+{
+    INSTRUMENTED_GET_STRING_LENGTH = 0,
+    INSTRUMENTED_REVERSE_STRING,
+    INSTRUMENTED_COMPARE_STRINGS,
+    INSTRUMENTED_STRING_SET_STRING,
+    INSTRUMENTED_STRING_APPEND,
+    INSTRUMENTED_STRING_TO_UPPER_CASE,
+    INSTRUMENTED_STRING_TO_LOWER_CASE,
+    INSTRUMENTED_STRING_INSERT,
+    INSTRUMENTED_STRING_ERASE,
+    INSTRUMENTED_TEXT_PROCESS_TEXT,
+    INSTRUMENTED_TEXT_REMOVE_WHITESPACE,
+    INSTRUMENTED_TEXT_CAPITALIZE_WORDS,
+    INSTRUMENTED_TEXT_COUNT_WORDS,
+    INSTRUMENTED_TEXT_COUNT_LINES,
+    INSTRUMENTED_INTERNER_INTERN,
+    INSTRUMENTED_TEXT_SPLIT,
+    INSTRUMENTED_TEXT_FILE_COUNT_LINES,
+    INSTRUMENTED_TEXT_FILE_COUNT_WORDS,
+    INSTRUMENTED_TEXT_FILE_REMOVE_WHITESPACE,
+    INSTRUMENTED_TEXT_FILE_CAPITALIZE_WORDS,
+    INSTRUMENTED_PARALLEL_TEXT_COUNT_WORDS,
+    INSTRUMENTED_PARALLEL_TEXT_COUNT_LINES,
+    INSTRUMENTED_PARALLEL_TEXT_REMOVE_WHITESPACE,
+    INSTRUMENTED_PARALLEL_TEXT_CAPITALIZE_WORDS,
+    INSTRUMENTED_TEXT_PIPELINE_RUN,
+    INSTRUMENTED_TEXT_STREAM_FEED,
+    INSTRUMENTED_STRING_FUNCTION_COUNT
+};
+
+struct StringInstrumentation
+{
+    static const int kFunctionCount = INSTRUMENTED_STRING_FUNCTION_COUNT;
+
+    static const char* GetName(int function)
+    {
+        static const char* const names[] = {
+            "GetStringLength",
+            "ReverseString",
+            "CompareStrings",
+            "StringUtility::SetString",
+            "StringUtility::Append",
+            "StringUtility::ToUpperCase",
+            "StringUtility::ToLowerCase",
+            "StringUtility::Insert",
+            "StringUtility::Erase",
+            "TextProcessor::ProcessText",
+            "TextProcessor::RemoveWhitespace",
+            "TextProcessor::CapitalizeWords",
+            "TextProcessor::CountWords",
+            "TextProcessor::CountLines",
+            "StringInterner::Intern",
+            "TextProcessor::Split",
+            "TextFileProcessor::CountLines",
+            "TextFileProcessor::CountWords",
+            "TextFileProcessor::RemoveWhitespace",
+            "TextFileProcessor::CapitalizeWords",
+            "ParallelTextProcessor::CountWords",
+            "ParallelTextProcessor::CountLines",
+            "ParallelTextProcessor::RemoveWhitespace",
+            "ParallelTextProcessor::CapitalizeWords",
+            "TextPipeline::Run",
+            "TextStreamSession::Feed"
+        };
+        static_assert(sizeof(names) / sizeof(names[0]) == INSTRUMENTED_STRING_FUNCTION_COUNT, "one name per StringLibraryFunction");
+        return names[function];
+    }
+};
+
+#define MYLIBRARY002_INSTRUMENT(function) MYLIB_INSTRUMENT_SCOPE(StringInstrumentation, function)
+
+#endif // STRINGINSTRUMENTATION_H
@@ -0,0 +1,366 @@
+//*******************************************************************************************************************
+//**  StringInterner.cpp - Concurrent String Intern Table (StringInterner, InternString exports)
+//**  64 lock-striped open-addressing tables that readers probe without locking, per-stripe text arenas,
+//**  and a segmented handle directory that maps handles back to their text without locking
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "MyLibrary002.h"
+#include "StringInstrumentation.h"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    const int kStripeCount = 64;                  // Power of two; picked by the high hash bits
+    const unsigned kInitialTableSize = 64;        // Slots per stripe, power of two
+    const size_t kTextChunkSize = 4 * 1024;
+    const int kDirectoryBaseBits = 10;            // Segment s holds 1024 << s entries
+    const int kDirectorySegments = 23;            // Enough for every 32-bit handle
+
+    struct Entry
+    {
+        const char* text;
+        unsigned length;
+        unsigned hash;
+    };
+
+    // Open addressing over handles (0 = empty); slots are only written under the stripe lock
+    struct SlotTable
+    {
+        unsigned mask;
+        std::atomic<unsigned>* slots;
+
+        explicit SlotTable(unsigned size) : mask(size - 1), slots(new std::atomic<unsigned>[size]())
+        {
+        }
+
+        ~SlotTable()
+        {
+            delete[] slots;
+        }
+    };
+
+    // FNV-1a, 32-bit
+    unsigned HashText(const char* text, size_t length)
+    {
+        unsigned hash = 2166136261u;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= static_cast<unsigned char>(text[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Handle h lives in segment floor(log2(h - 1 + 1024)) - 10
+    void LocateHandle(unsigned handle, int* segment, size_t* offset)
+    {
+        unsigned long long index = static_cast<unsigned long long>(handle) - 1 + (1ULL << kDirectoryBaseBits);
+        int log2 = 0;
+        while ((index >> (log2 + 1)) != 0)
+            log2++;
+        *segment = log2 - kDirectoryBaseBits;
+        *offset = static_cast<size_t>(index - (1ULL << log2));
+    }
+}
+
+struct StringInterner::Storage
+{
+    struct alignas(64) Stripe
+    {
+        std::mutex mutex;
+        std::atomic<SlotTable*> table;
+        unsigned count;
+        std::vector<SlotTable*> retired;  // Readers may still probe a replaced table; freed with the interner
+
+        // Text arena, only touched under the stripe lock
+        std::vector<char*> chunks;
+        char* chunk;
+        size_t chunkUsed;
+        size_t chunkSize;
+
+        Stripe() : table(new SlotTable(kInitialTableSize)), count(0), chunk(nullptr), chunkUsed(0), chunkSize(0) {}
+    };
+
+    Stripe stripes[kStripeCount];
+    std::atomic<Entry*> segments[kDirectorySegments];
+    std::mutex segmentMutex;
+    std::atomic<unsigned> handleCount;
+
+    std::atomic<unsigned long long> stringBytes;
+    std::atomic<unsigned long long> arenaBytes;
+    std::atomic<unsigned long long> tableBytes;
+    std::atomic<unsigned long long> directoryBytes;
+
+    Storage() : handleCount(0), stringBytes(0), arenaBytes(0), tableBytes(0), directoryBytes(0)
+    {
+        for (int segment = 0; segment < kDirectorySegments; segment++)
+            segments[segment].store(nullptr, std::memory_order_relaxed);
+        tableBytes.store(static_cast<unsigned long long>(kStripeCount) * kInitialTableSize * sizeof(unsigned), std::memory_order_relaxed);
+    }
+
+    ~Storage()
+    {
+        for (int s = 0; s < kStripeCount; s++)
+        {
+            Stripe& stripe = stripes[s];
+            delete stripe.table.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < stripe.retired.size(); i++)
+                delete stripe.retired[i];
+            for (size_t i = 0; i < stripe.chunks.size(); i++)
+                delete[] stripe.chunks[i];
+        }
+        for (int segment = 0; segment < kDirectorySegments; segment++)
+            delete[] segments[segment].load(std::memory_order_relaxed);
+    }
+
+    static Stripe& SelectStripe(Stripe* stripes, unsigned hash)
+    {
+        return stripes[hash >> 26];
+    }
+
+    const Entry* GetEntry(unsigned handle) const
+    {
+        if (handle == kInvalidHandle || handle > handleCount.load(std::memory_order_acquire))
+            return nullptr;
+        int segment = 0;
+        size_t offset = 0;
+        LocateHandle(handle, &segment, &offset);
+        const Entry* entries = segments[segment].load(std::memory_order_acquire);
+        return (entries != nullptr) ? &entries[offset] : nullptr;
+    }
+
+    // Lock-free probe; a slot is published (release) only after its entry and text are written
+    unsigned Probe(const SlotTable* table, const char* text, size_t length, unsigned hash) const
+    {
+        for (unsigned slot = hash & table->mask;; slot = (slot + 1) & table->mask)
+        {
+            unsigned handle = table->slots[slot].load(std::memory_order_acquire);
+            if (handle == kInvalidHandle)
+                return kInvalidHandle;
+            int segment = 0;
+            size_t offset = 0;
+            LocateHandle(handle, &segment, &offset);
+            const Entry& entry = segments[segment].load(std::memory_order_acquire)[offset];
+            if (entry.hash == hash && entry.length == length && memcmp(entry.text, text, length) == 0)
+                return handle;
+        }
+    }
+
+    unsigned Find(const char* text, size_t length, unsigned hash)
+    {
+        Stripe& stripe = SelectStripe(stripes, hash);
+        return Probe(stripe.table.load(std::memory_order_acquire), text, length, hash);
+    }
+
+    // Caller holds the stripe lock
+    const char* StoreText(Stripe& stripe, const char* text, size_t length)
+    {
+        const size_t bytes = length + 1;
+        char* destination = nullptr;
+        if (bytes > kTextChunkSize / 4)
+        {
+            // Long strings get their own block instead of wasting a chunk tail
+            destination = new char[bytes];
+            stripe.chunks.push_back(destination);
+            arenaBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+        else
+        {
+            if (stripe.chunk == nullptr || stripe.chunkUsed + bytes > stripe.chunkSize)
+            {
+                stripe.chunk = new char[kTextChunkSize];
+                stripe.chunks.push_back(stripe.chunk);
+                stripe.chunkUsed = 0;
+                stripe.chunkSize = kTextChunkSize;
+                arenaBytes.fetch_add(kTextChunkSize, std::memory_order_relaxed);
+            }
+            destination = stripe.chunk + stripe.chunkUsed;
+            stripe.chunkUsed += bytes;
+        }
+        memcpy(destination, text, length);
+        destination[length] = '\0';
+        stringBytes.fetch_add(bytes, std::memory_order_relaxed);
+        return destination;
+    }
+
+    // Takes the next handle, fills its directory entry and publishes it; kInvalidHandle once handles run out
+    // New strings are rare next to lookups, so one short lock here is cheaper than a lock-free directory append
+    unsigned AddEntry(const char* text, size_t length, unsigned hash)
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        const unsigned handle = handleCount.load(std::memory_order_relaxed) + 1;
+        if (handle == kInvalidHandle)
+            return kInvalidHandle;
+        int segment = 0;
+        size_t offset = 0;
+        LocateHandle(handle, &segment, &offset);
+        Entry* entries = segments[segment].load(std::memory_order_relaxed);
+        if (entries == nullptr)
+        {
+            const size_t size = static_cast<size_t>(1) << (kDirectoryBaseBits + segment);
+            entries = new Entry[size]();
+            segments[segment].store(entries, std::memory_order_release);
+            directoryBytes.fetch_add(size * sizeof(Entry), std::memory_order_relaxed);
+        }
+        entries[offset].text = text;
+        entries[offset].length = static_cast<unsigned>(length);
+        entries[offset].hash = hash;
+        handleCount.store(handle, std::memory_order_release);
+        return handle;
+    }
+
+    // Caller holds the stripe lock; doubles the table at half load and retires the old one
+    void Insert(Stripe& stripe, unsigned handle, unsigned hash)
+    {
+        SlotTable* table = stripe.table.load(std::memory_order_relaxed);
+        if ((stripe.count + 1) * 2 > table->mask + 1)
+        {
+            SlotTable* grown = new SlotTable((table->mask + 1) * 2);
+            for (unsigned slot = 0; slot <= table->mask; slot++)
+            {
+                unsigned existing = table->slots[slot].load(std::memory_order_relaxed);
+                if (existing != kInvalidHandle)
+                    PlaceHandle(grown, existing, GetEntry(existing)->hash);
+            }
+            stripe.table.store(grown, std::memory_order_release);
+            stripe.retired.push_back(table);
+            tableBytes.fetch_add(static_cast<unsigned long long>(grown->mask + 1) * sizeof(unsigned), std::memory_order_relaxed);
+            table = grown;
+        }
+        PlaceHandle(table, handle, hash);
+        stripe.count++;
+    }
+
+    static void PlaceHandle(SlotTable* table, unsigned handle, unsigned hash)
+    {
+        unsigned slot = hash & table->mask;
+        while (table->slots[slot].load(std::memory_order_relaxed) != kInvalidHandle)
+            slot = (slot + 1) & table->mask;
+        table->slots[slot].store(handle, std::memory_order_release);
+    }
+};
+
+// ============================================================================
+// StringInterner class implementation
+// ============================================================================
+
+StringInterner::StringInterner() : m_storage(new Storage())
+{
+}
+
+StringInterner::~StringInterner()
+{
+    delete m_storage;
+}
+
+unsigned int StringInterner::Intern(const char* str)
+{
+    if (str == nullptr)
+        return kInvalidHandle;
+    return Intern(str, strlen(str));
+}
+
+unsigned int StringInterner::Intern(const char* str, size_t length)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_INTERNER_INTERN);
+    if (str == nullptr || length > 0xFFFFFFFFu)
+        return kInvalidHandle;
+
+    const unsigned hash = HashText(str, length);
+    unsigned handle = m_storage->Find(str, length, hash);
+    if (handle != kInvalidHandle)
+        return handle;
+
+    Storage::Stripe& stripe = Storage::SelectStripe(m_storage->stripes, hash);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    // Another thread may have added it between the lock-free probe and the lock
+    handle = m_storage->Probe(stripe.table.load(std::memory_order_relaxed), str, length, hash);
+    if (handle != kInvalidHandle)
+        return handle;
+
+    handle = m_storage->AddEntry(m_storage->StoreText(stripe, str, length), length, hash);
+    if (handle != kInvalidHandle)
+        m_storage->Insert(stripe, handle, hash);
+    return handle;
+}
+
+unsigned int StringInterner::Find(const char* str) const
+{
+    if (str == nullptr)
+        return kInvalidHandle;
+    return Find(str, strlen(str));
+}
+
+unsigned int StringInterner::Find(const char* str, size_t length) const
+{
+    if (str == nullptr || length > 0xFFFFFFFFu)
+        return kInvalidHandle;
+    return m_storage->Find(str, length, HashText(str, length));
+}
+
+const char* StringInterner::GetString(unsigned int handle) const
+{
+    const Entry* entry = m_storage->GetEntry(handle);
+    return (entry != nullptr) ? entry->text : nullptr;
+}
+
+size_t StringInterner::GetLength(unsigned int handle) const
+{
+    const Entry* entry = m_storage->GetEntry(handle);
+    return (entry != nullptr) ? entry->length : 0;
+}
+
+size_t StringInterner::GetCount() const
+{
+    return m_storage->handleCount.load(std::memory_order_acquire);
+}
+
+void StringInterner::GetStatistics(InternerStatistics* stats) const
+{
+    if (stats == nullptr)
+        return;
+    stats->stringCount = m_storage->handleCount.load(std::memory_order_acquire);
+    stats->stringBytes = m_storage->stringBytes.load(std::memory_order_relaxed);
+    stats->arenaBytes = m_storage->arenaBytes.load(std::memory_order_relaxed);
+    stats->tableBytes = m_storage->tableBytes.load(std::memory_order_relaxed);
+    stats->directoryBytes = m_storage->directoryBytes.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Process-wide interner and C-style exports
+// ============================================================================
+
+MYLIBRARY002_API StringInterner& GetStringInternerInstance()
+{
+    // Never deleted, so handles and their text stay valid until the process exits
+    static StringInterner* instance = new StringInterner();
+    return *instance;
+}
+
+extern "C" {
+    MYLIBRARY002_API unsigned int InternString(const char* str)
+    {
+        return GetStringInternerInstance().Intern(str);
+    }
+
+    MYLIBRARY002_API const char* GetInternedString(unsigned int handle)
+    {
+        return GetStringInternerInstance().GetString(handle);
+    }
+
+    MYLIBRARY002_API int CompareInternedStrings(unsigned int handle1, unsigned int handle2)
+    {
+        if (handle1 == handle2)
+            return 0;
+        return CompareStrings(GetInternedString(handle1), GetInternedString(handle2));
+    }
+
+    MYLIBRARY002_API void GetInternerStatistics(InternerStatistics* stats)
+    {
+        GetStringInternerInstance().GetStatistics(stats);
+    }
+}
@@ -0,0 +1,307 @@
+//*******************************************************************************************************************
+//**  StringMemory.cpp - Memory Resources for MyLibrary002 Strings (MonotonicArena, SizeClassPool)
+//**  std::pmr::memory_resource implementations accepted by StringUtility and the TextProcessor result overloads
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "MyLibrary002.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// MonotonicArena class implementation
+// ============================================================================
+
+struct MonotonicArena::Block
+{
+    Block* next;
+    size_t size;    // Including this header
+};
+
+namespace
+{
+    const size_t kBlockAlignment = alignof(std::max_align_t);
+    const size_t kBlockHeaderSize = (sizeof(MonotonicArena::Block) + kBlockAlignment - 1) / kBlockAlignment * kBlockAlignment;
+
+    char* AlignUp(char* pointer, size_t alignment)
+    {
+        uintptr_t value = reinterpret_cast<uintptr_t>(pointer);
+        return reinterpret_cast<char*>((value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+    }
+}
+
+MonotonicArena::MonotonicArena(size_t initialBlockSize, std::pmr::memory_resource* upstream)
+    : m_upstream((upstream != nullptr) ? upstream : std::pmr::new_delete_resource()),
+      m_blocks(nullptr), m_current(nullptr), m_end(nullptr),
+      m_initialBlockSize((initialBlockSize > 1024) ? initialBlockSize : 1024),
+      m_nextBlockSize(m_initialBlockSize), m_bytesUsed(0), m_bytesReserved(0)
+{
+}
+
+MonotonicArena::~MonotonicArena()
+{
+    while (m_blocks != nullptr)
+    {
+        Block* next = m_blocks->next;
+        m_upstream->deallocate(m_blocks, m_blocks->size, kBlockAlignment);
+        m_blocks = next;
+    }
+}
+
+// Every block but the newest goes back upstream; the newest is the largest, so a steady workload stops allocating
+void MonotonicArena::Reset()
+{
+    if (m_blocks != nullptr)
+    {
+        Block* older = m_blocks->next;
+        while (older != nullptr)
+        {
+            Block* next = older->next;
+            m_bytesReserved -= older->size;
+            m_upstream->deallocate(older, older->size, kBlockAlignment);
+            older = next;
+        }
+        m_blocks->next = nullptr;
+        m_current = reinterpret_cast<char*>(m_blocks) + kBlockHeaderSize;
+        m_end = reinterpret_cast<char*>(m_blocks) + m_blocks->size;
+    }
+    m_bytesUsed = 0;
+}
+
+size_t MonotonicArena::GetBytesUsed() const
+{
+    return m_bytesUsed;
+}
+
+size_t MonotonicArena::GetBytesReserved() const
+{
+    return m_bytesReserved;
+}
+
+void* MonotonicArena::do_allocate(size_t bytes, size_t alignment)
+{
+    char* result = AlignUp(m_current, alignment);
+    if (m_current == nullptr || result > m_end || static_cast<size_t>(m_end - result) < bytes)
+    {
+        // Blocks double so the number of upstream calls grows only logarithmically with the request size
+        size_t needed = kBlockHeaderSize + bytes + alignment;
+        size_t size = (m_nextBlockSize > needed) ? m_nextBlockSize : needed;
+        Block* block = static_cast<Block*>(m_upstream->allocate(size, kBlockAlignment));
+        block->next = m_blocks;
+        block->size = size;
+        m_blocks = block;
+        m_bytesReserved += size;
+        m_nextBlockSize = size * 2;
+
+        m_current = reinterpret_cast<char*>(block) + kBlockHeaderSize;
+        m_end = reinterpret_cast<char*>(block) + size;
+        result = AlignUp(m_current, alignment);
+    }
+    m_current = result + bytes;
+    m_bytesUsed += bytes;
+    return result;
+}
+
+void MonotonicArena::do_deallocate(void* /*pointer*/, size_t /*bytes*/, size_t /*alignment*/)
+{
+    // Memory is reclaimed by Reset or the destructor
+}
+
+bool MonotonicArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+// ============================================================================
+// SizeClassPool class implementation
+// ============================================================================
+// Size class c holds blocks of 16 << c bytes. Slabs are carved into blocks on demand and kept for the life
+// of the process. Thread caches move blocks to and from the shared lists in batches of kTransferCount.
+
+namespace
+{
+    const int kSizeClassCount = 9;          // 16 .. 4096 bytes
+    const size_t kMinBlockSize = 16;
+    const size_t kSlabSize = 64 * 1024;
+    const int kTransferCount = 32;
+    const int kMaxCachedCount = 2 * kTransferCount;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    int GetSizeClass(size_t bytes)
+    {
+        int sizeClass = 0;
+        while ((kMinBlockSize << sizeClass) < bytes)
+            sizeClass++;
+        return sizeClass;
+    }
+}
+
+struct SizeClassPool::Central
+{
+    struct SizeClassList
+    {
+        std::mutex mutex;
+        FreeBlock* head;
+        std::vector<void*> slabs;
+
+        SizeClassList() : head(nullptr) {}
+    };
+
+    SizeClassList lists[kSizeClassCount];
+    std::atomic<size_t> bytesReserved;
+
+    Central() : bytesReserved(0) {}
+
+    // Moves up to count blocks into *chain, carving a new slab when the list runs dry; returns the number moved
+    int Take(int sizeClass, int count, FreeBlock** chain)
+    {
+        SizeClassList& list = lists[sizeClass];
+        std::lock_guard<std::mutex> lock(list.mutex);
+        if (list.head == nullptr)
+        {
+            const size_t blockSize = kMinBlockSize << sizeClass;
+            char* slab = static_cast<char*>(::operator new(kSlabSize));
+            list.slabs.push_back(slab);
+            bytesReserved.fetch_add(kSlabSize, std::memory_order_relaxed);
+            for (size_t offset = kSlabSize; offset >= blockSize; offset -= blockSize)
+            {
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + offset - blockSize);
+                block->next = list.head;
+                list.head = block;
+            }
+        }
+
+        int taken = 0;
+        FreeBlock* head = nullptr;
+        while (taken < count && list.head != nullptr)
+        {
+            FreeBlock* block = list.head;
+            list.head = block->next;
+            block->next = head;
+            head = block;
+            taken++;
+        }
+        *chain = head;
+        return taken;
+    }
+
+    void Give(int sizeClass, FreeBlock* first, FreeBlock* last)
+    {
+        SizeClassList& list = lists[sizeClass];
+        std::lock_guard<std::mutex> lock(list.mutex);
+        last->next = list.head;
+        list.head = first;
+    }
+};
+
+namespace
+{
+    // Per-thread free lists; returned to the shared lists when the thread exits
+    struct ThreadCache
+    {
+        SizeClassPool::Central* central;
+        FreeBlock* heads[kSizeClassCount];
+        int counts[kSizeClassCount];
+
+        ThreadCache() : central(nullptr)
+        {
+            for (int sizeClass = 0; sizeClass < kSizeClassCount; sizeClass++)
+            {
+                heads[sizeClass] = nullptr;
+                counts[sizeClass] = 0;
+            }
+        }
+
+        ~ThreadCache()
+        {
+            for (int sizeClass = 0; sizeClass < kSizeClassCount; sizeClass++)
+                Flush(sizeClass, counts[sizeClass]);
+        }
+
+        // Returns the first count cached blocks of a class to the shared list
+        void Flush(int sizeClass, int count)
+        {
+            if (count <= 0)
+                return;
+            FreeBlock* first = heads[sizeClass];
+            FreeBlock* last = first;
+            for (int i = 1; i < count; i++)
+                last = last->next;
+            heads[sizeClass] = last->next;
+            counts[sizeClass] -= count;
+            central->Give(sizeClass, first, last);
+        }
+    };
+
+    ThreadCache& GetThreadCache(SizeClassPool::Central* central)
+    {
+        static thread_local ThreadCache cache;
+        cache.central = central;
+        return cache;
+    }
+}
+
+SizeClassPool& SizeClassPool::Instance()
+{
+    // Never deleted: thread caches flush into it from thread exit handlers during shutdown
+    static SizeClassPool* instance = new SizeClassPool();
+    return *instance;
+}
+
+SizeClassPool::SizeClassPool() : m_central(new Central())
+{
+}
+
+SizeClassPool::~SizeClassPool()
+{
+}
+
+size_t SizeClassPool::GetBytesReserved() const
+{
+    return m_central->bytesReserved.load(std::memory_order_relaxed);
+}
+
+void* SizeClassPool::do_allocate(size_t bytes, size_t alignment)
+{
+    if (bytes > kMaxPooledSize || alignment > kMinBlockSize)
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+
+    const int sizeClass = GetSizeClass(bytes);
+    ThreadCache& cache = GetThreadCache(m_central);
+    if (cache.heads[sizeClass] == nullptr)
+        cache.counts[sizeClass] = m_central->Take(sizeClass, kTransferCount, &cache.heads[sizeClass]);
+
+    FreeBlock* block = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block->next;
+    cache.counts[sizeClass]--;
+    return block;
+}
+
+void SizeClassPool::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+{
+    if (bytes > kMaxPooledSize || alignment > kMinBlockSize)
+    {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        return;
+    }
+
+    const int sizeClass = GetSizeClass(bytes);
+    ThreadCache& cache = GetThreadCache(m_central);
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    block->next = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block;
+    // A thread that only frees (a consumer) hands blocks back instead of hoarding them
+    if (++cache.counts[sizeClass] > kMaxCachedCount)
+        cache.Flush(sizeClass, kTransferCount);
+}
+
+bool SizeClassPool::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
@@ -0,0 +1,164 @@
+//*******************************************************************************************************************
+//**  TextFileProcessor.cpp - Memory-Mapped Text File Processing
+//**  Walks text files window by window through Common/MappedFile.h with the TextKernels word and line kernels
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "MyLibrary002.h"
+#include "StringInstrumentation.h"
+#include "TextKernels.h"
+#include "../Common/MappedFile.h"
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const long long kDefaultWindowSize = 16LL * 1024 * 1024;
+
+    size_t GetAlignedWindowSize(long long windowSize)
+    {
+        const size_t granularity = MappedFile::GetGranularity();
+        size_t size = static_cast<size_t>(windowSize);
+        return (size + granularity - 1) / granularity * granularity;
+    }
+
+    FILE* OpenOutputFile(const char* path)
+    {
+#ifdef _WIN32
+        FILE* file = nullptr;
+        if (fopen_s(&file, path, "wb") != 0)
+            return nullptr;
+        return file;
+#else
+        return fopen(path, "wb");
+#endif
+    }
+
+    // Calls visit(window, length) for every window of the file in order; false if a window cannot be mapped
+    template <typename Visit>
+    bool ForEachWindow(MappedFile& file, size_t windowSize, Visit visit)
+    {
+        for (unsigned long long offset = 0; offset < file.GetSize(); offset += windowSize)
+        {
+            size_t length = 0;
+            const char* window = file.MapWindow(offset, windowSize, &length);
+            if (window == nullptr)
+                return false;
+            if (!visit(window, length))
+                return false;
+        }
+        return true;
+    }
+
+    // Transforms every window into buffer and appends it to outPath
+    // transform(window, length, buffer) returns the number of bytes to write
+    template <typename Transform>
+    bool TransformFile(const char* path, const char* outPath, size_t windowSize, Transform transform)
+    {
+        if (outPath == nullptr)
+            return false;
+        MappedFile file;
+        if (!file.Open(path))
+            return false;
+
+        FILE* out = OpenOutputFile(outPath);
+        if (out == nullptr)
+            return false;
+
+        std::vector<char> buffer(file.GetSize() < windowSize ? static_cast<size_t>(file.GetSize()) : windowSize);
+        bool ok = ForEachWindow(file, windowSize, [&](const char* window, size_t length) {
+            size_t written = transform(window, length, buffer.data());
+            return fwrite(buffer.data(), 1, written, out) == written;
+        });
+
+        if (fclose(out) != 0)
+            ok = false;
+        return ok;
+    }
+}
+
+// ============================================================================
+// TextFileProcessor class implementation
+// ============================================================================
+
+TextFileProcessor::TextFileProcessor() : m_windowSize(kDefaultWindowSize)
+{
+}
+
+TextFileProcessor::~TextFileProcessor()
+{
+}
+
+void TextFileProcessor::SetWindowSize(long long bytes)
+{
+    m_windowSize = (bytes > 0) ? bytes : kDefaultWindowSize;
+}
+
+long long TextFileProcessor::GetWindowSize() const
+{
+    return static_cast<long long>(GetAlignedWindowSize(m_windowSize));
+}
+
+bool TextFileProcessor::CountLines(const char* path, long long* lines)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_FILE_COUNT_LINES);
+    if (lines == nullptr)
+        return false;
+    MappedFile file;
+    if (!file.Open(path))
+        return false;
+
+    // Newlines never span a window edge; only the "at least one line" rule needs the whole file
+    unsigned long long newlines = 0;
+    bool ok = ForEachWindow(file, GetAlignedWindowSize(m_windowSize), [&](const char* window, size_t length) {
+        newlines += TextKernels::CountNewlines(window, length);
+        return true;
+    });
+    if (!ok)
+        return false;
+
+    *lines = (file.GetSize() == 0) ? 0 : static_cast<long long>(newlines + 1);
+    return true;
+}
+
+bool TextFileProcessor::CountWords(const char* path, long long* words)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_FILE_COUNT_WORDS);
+    if (words == nullptr)
+        return false;
+    MappedFile file;
+    if (!file.Open(path))
+        return false;
+
+    // inWord carries across windows, so a word cut by a window edge is counted once, in the window it starts in
+    unsigned long long count = 0;
+    bool inWord = false;
+    bool ok = ForEachWindow(file, GetAlignedWindowSize(m_windowSize), [&](const char* window, size_t length) {
+        count += TextKernels::CountWords(window, length, &inWord);
+        return true;
+    });
+    if (!ok)
+        return false;
+
+    *words = static_cast<long long>(count);
+    return true;
+}
+
+bool TextFileProcessor::RemoveWhitespace(const char* path, const char* outPath)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_FILE_REMOVE_WHITESPACE);
+    return TransformFile(path, outPath, GetAlignedWindowSize(m_windowSize), [](const char* window, size_t length, char* buffer) {
+        return TextKernels::RemoveWhitespace(window, buffer, length);
+    });
+}
+
+bool TextFileProcessor::CapitalizeWords(const char* path, const char* outPath)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_FILE_CAPITALIZE_WORDS);
+    // newWord carries across windows, so a word cut by a window edge keeps its lowercase tail
+    bool newWord = true;
+    return TransformFile(path, outPath, GetAlignedWindowSize(m_windowSize), [&](const char* window, size_t length, char* buffer) {
+        newWord = TextKernels::CapitalizeWords(window, buffer, length, newWord);
+        return length;
+    });
+}
@@ -0,0 +1,887 @@
+//*******************************************************************************************************************
+//**  TextKernels.cpp - SIMD Text Kernels Implementation
+//**  Case conversion and word capitalization, 32 (AVX2) or 16 (SSE2) ASCII bytes per step
+//**  Blocks containing bytes >= 0x80 and all tails go through the 256-entry tables
+//**  NUL-terminated length and compare, and in-place reverse, one block per step
+//**  Word and newline counts from 64-byte class bitmasks and popcount
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "TextKernels.h"
+#include <cstdint>
+#include <cstring>
+
+// Block loads may read bytes past a terminator (never past its page); AddressSanitizer would report them
+#if defined(_MSC_VER)
+#define TEXT_KERNEL_NO_ASAN __declspec(no_sanitize_address)
+#elif defined(__GNUC__) || defined(__clang__)
+#define TEXT_KERNEL_NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define TEXT_KERNEL_NO_ASAN
+#endif
+
+// ============================================================================
+// Table kernels (scalar level, non-ASCII blocks and tails)
+// ============================================================================
+
+namespace
+{
+    // C locale classification, independent of whatever setlocale the host application called
+    struct CaseTables
+    {
+        unsigned char upper[256];
+        unsigned char lower[256];
+        bool space[256];
+    };
+
+    CaseTables BuildCaseTables()
+    {
+        CaseTables tables;
+        for (int c = 0; c < 256; c++)
+        {
+            tables.upper[c] = static_cast<unsigned char>((c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c);
+            tables.lower[c] = static_cast<unsigned char>((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+            tables.space[c] = (c == ' ') || (c >= '\t' && c <= '\r');
+        }
+        return tables;
+    }
+
+    const CaseTables& GetCaseTables()
+    {
+        static const CaseTables tables = BuildCaseTables();
+        return tables;
+    }
+
+    void ConvertTable(char* data, size_t length, const unsigned char* table)
+    {
+        for (size_t i = 0; i < length; i++)
+            data[i] = static_cast<char>(table[static_cast<unsigned char>(data[i])]);
+    }
+
+    void ToUpperScalar(char* data, size_t length)
+    {
+        ConvertTable(data, length, GetCaseTables().upper);
+    }
+
+    void ToLowerScalar(char* data, size_t length)
+    {
+        ConvertTable(data, length, GetCaseTables().lower);
+    }
+
+    bool CapitalizeScalar(const char* input, char* output, size_t length, bool newWord)
+    {
+        const CaseTables& tables = GetCaseTables();
+        for (size_t i = 0; i < length; i++)
+        {
+            unsigned char c = static_cast<unsigned char>(input[i]);
+            if (tables.space[c])
+            {
+                output[i] = static_cast<char>(c);
+                newWord = true;
+            }
+            else
+            {
+                output[i] = static_cast<char>(newWord ? tables.upper[c] : tables.lower[c]);
+                newWord = false;
+            }
+        }
+        return newWord;
+    }
+
+    bool IsSpace(char c)
+    {
+        return GetCaseTables().space[static_cast<unsigned char>(c)];
+    }
+
+    // -1, 0 or 1, ordering bytes as unsigned like strcmp
+    int CompareBytes(unsigned char a, unsigned char b)
+    {
+        return (a > b) - (a < b);
+    }
+
+    // Eight bytes per step once aligned; an aligned word never straddles a page
+    TEXT_KERNEL_NO_ASAN size_t StringLengthScalar(const char* str)
+    {
+        const char* p = str;
+        for (; (reinterpret_cast<uintptr_t>(p) & 7) != 0; p++)
+        {
+            if (*p == '\0')
+                return static_cast<size_t>(p - str);
+        }
+
+        const unsigned long long ones = 0x0101010101010101ULL;
+        const unsigned long long highs = 0x8080808080808080ULL;
+        for (;; p += 8)
+        {
+            unsigned long long word;
+            memcpy(&word, p, sizeof(word));
+            if (((word - ones) & ~word & highs) != 0)
+                break;
+        }
+        while (*p != '\0')
+            p++;
+        return static_cast<size_t>(p - str);
+    }
+
+    int CompareScalar(const char* a, const char* b)
+    {
+        while (*a != '\0' && *a == *b)
+        {
+            a++;
+            b++;
+        }
+        return CompareBytes(static_cast<unsigned char>(*a), static_cast<unsigned char>(*b));
+    }
+
+    void ReverseScalar(char* data, size_t length)
+    {
+        if (length < 2)
+            return;
+        char* front = data;
+        char* back = data + length - 1;
+        while (front < back)
+        {
+            char c = *front;
+            *front++ = *back;
+            *back-- = c;
+        }
+    }
+
+    // Bit-parallel population count for levels that cannot assume the POPCNT instruction
+    inline size_t PopCountPortable(unsigned long long x)
+    {
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<size_t>((x * 0x0101010101010101ULL) >> 56);
+    }
+
+    // A word starts at every non-space byte whose predecessor is a space (or, for the first byte, when !*inWord)
+    size_t CountWordsScalar(const char* data, size_t length, bool* inWord)
+    {
+        const bool* space = GetCaseTables().space;
+        size_t count = 0;
+        bool state = *inWord;
+        for (size_t i = 0; i < length; i++)
+        {
+            bool word = !space[static_cast<unsigned char>(data[i])];
+            count += (word && !state) ? 1 : 0;
+            state = word;
+        }
+        *inWord = state;
+        return count;
+    }
+
+    size_t CountNonSpaceScalar(const char* data, size_t length)
+    {
+        const bool* space = GetCaseTables().space;
+        size_t count = 0;
+        for (size_t i = 0; i < length; i++)
+            count += space[static_cast<unsigned char>(data[i])] ? 0 : 1;
+        return count;
+    }
+
+    // Eight bytes per step: the high bit of every byte of x that is not '\n' is set, exactly, then the rest are counted
+    size_t CountNewlinesScalar(const char* data, size_t length)
+    {
+        const unsigned long long newlines = 0x0A0A0A0A0A0A0A0AULL;
+        const unsigned long long lows = 0x7F7F7F7F7F7F7F7FULL;
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8)
+        {
+            unsigned long long word;
+            memcpy(&word, data + i, sizeof(word));
+            unsigned long long x = word ^ newlines;
+            unsigned long long nonZero = (((x & lows) + lows) | x) & ~lows;
+            count += 8 - PopCountPortable(nonZero);
+        }
+        for (; i < length; i++)
+            count += (data[i] == '\n') ? 1 : 0;
+        return count;
+    }
+
+#ifdef MYLIB_X86
+    const uintptr_t kPageSize = 4096;
+
+    // Bytes from p to the end of the nearer of the two pages, 1 .. kPageSize
+    inline size_t PageRoom(const char* a, const char* b)
+    {
+        uintptr_t roomA = kPageSize - (reinterpret_cast<uintptr_t>(a) & (kPageSize - 1));
+        uintptr_t roomB = kPageSize - (reinterpret_cast<uintptr_t>(b) & (kPageSize - 1));
+        return static_cast<size_t>((roomA < roomB) ? roomA : roomB);
+    }
+
+    inline int CountTrailingZeros(unsigned mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+#endif
+
+#ifdef MYLIB_X86
+    // ============================================================================
+    // SSE2 kernels (16 bytes per step)
+    // ============================================================================
+    // Signed byte compares: bytes >= 0x80 are negative and never fall inside a letter or space range
+
+    inline __m128i InRangeSSE2(__m128i v, char first, char last)
+    {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(first - 1))),
+                             _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(last + 1))));
+    }
+
+    inline __m128i SpaceMaskSSE2(__m128i v)
+    {
+        return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), InRangeSSE2(v, '\t', '\r'));
+    }
+
+    void ConvertSSE2(char* data, size_t length, char first, char last, const unsigned char* table)
+    {
+        const __m128i caseBit = _mm_set1_epi8(0x20);
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            if (_mm_movemask_epi8(v) != 0)
+            {
+                ConvertTable(data + i, 16, table);
+                continue;
+            }
+            __m128i flip = _mm_and_si128(InRangeSSE2(v, first, last), caseBit);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(v, flip));
+        }
+        ConvertTable(data + i, length - i, table);
+    }
+
+    void ToUpperSSE2(char* data, size_t length)
+    {
+        ConvertSSE2(data, length, 'a', 'z', GetCaseTables().upper);
+    }
+
+    void ToLowerSSE2(char* data, size_t length)
+    {
+        ConvertSSE2(data, length, 'A', 'Z', GetCaseTables().lower);
+    }
+
+    // A letter flips its case bit when it is lowercase after whitespace or uppercase after a non-space byte
+    // The previous bytes come from an unaligned load one byte back, so the first byte is done by the table
+    // In-place use is safe: rewriting a byte never changes whether it is whitespace
+    bool CapitalizeSSE2(const char* input, char* output, size_t length, bool newWord)
+    {
+        if (length == 0)
+            return newWord;
+        newWord = CapitalizeScalar(input, output, 1, newWord);
+
+        const __m128i caseBit = _mm_set1_epi8(0x20);
+        size_t i = 1;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+            if (_mm_movemask_epi8(v) != 0)
+            {
+                CapitalizeScalar(input + i, output + i, 16, IsSpace(input[i - 1]));
+                continue;
+            }
+            __m128i afterSpace = SpaceMaskSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i - 1)));
+            __m128i flip = _mm_or_si128(_mm_and_si128(afterSpace, InRangeSSE2(v, 'a', 'z')),
+                                        _mm_andnot_si128(afterSpace, InRangeSSE2(v, 'A', 'Z')));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_xor_si128(v, _mm_and_si128(flip, caseBit)));
+        }
+        return CapitalizeScalar(input + i, output + i, length - i, IsSpace(input[i - 1]));
+    }
+
+    // Aligned loads from the block holding str; the bytes in front of str are shifted out of the first mask
+    TEXT_KERNEL_NO_ASAN size_t StringLengthSSE2(const char* str)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const uintptr_t skip = reinterpret_cast<uintptr_t>(str) & 15;
+        const char* block = str - skip;
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero))) >> skip;
+        if (mask != 0)
+            return static_cast<size_t>(CountTrailingZeros(mask));
+        for (;;)
+        {
+            block += 16;
+            mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero)));
+            if (mask != 0)
+                return static_cast<size_t>(block - str) + CountTrailingZeros(mask);
+        }
+    }
+
+    // min(a, eq) is zero exactly where the bytes differ or a ends, so several blocks fold into one test
+    inline __m128i StopVectorSSE2(const char* a, const char* b)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        return _mm_min_epu8(va, _mm_cmpeq_epi8(va, _mm_loadu_si128(reinterpret_cast<const __m128i*>(b))));
+    }
+
+    // Mask of the bytes that differ or end a
+    inline unsigned CompareMaskSSE2(const char* a, const char* b)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(
+            _mm_xor_si128(_mm_cmpeq_epi8(va, vb), _mm_set1_epi8(-1)), _mm_cmpeq_epi8(va, _mm_setzero_si128()))));
+    }
+
+    // Whole blocks until either string nears a page end. The last bytes of the page are covered by one more block
+    // that ends exactly there and overlaps bytes already found equal; only the first bytes of a are done one by one
+    TEXT_KERNEL_NO_ASAN int CompareSSE2(const char* a, const char* b)
+    {
+        const char* start = a;
+        for (;;)
+        {
+            size_t room = PageRoom(a, b);
+            for (; room >= 64; room -= 64, a += 64, b += 64)
+            {
+                __m128i folded = _mm_min_epu8(_mm_min_epu8(StopVectorSSE2(a, b), StopVectorSSE2(a + 16, b + 16)),
+                                              _mm_min_epu8(StopVectorSSE2(a + 32, b + 32), StopVectorSSE2(a + 48, b + 48)));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(folded, _mm_setzero_si128())) != 0)
+                    break;
+            }
+            for (; room >= 16; room -= 16, a += 16, b += 16)
+            {
+                unsigned stop = CompareMaskSSE2(a, b);
+                if (stop != 0)
+                {
+                    int i = CountTrailingZeros(stop);
+                    return CompareBytes(static_cast<unsigned char>(a[i]), static_cast<unsigned char>(b[i]));
+                }
+            }
+            if (room == 0)
+                continue;
+            const size_t back = 16 - room;
+            if (static_cast<size_t>(a - start) >= back)
+            {
+                unsigned stop = CompareMaskSSE2(a - back, b - back) >> back;
+                if (stop != 0)
+                {
+                    int i = CountTrailingZeros(stop);
+                    return CompareBytes(static_cast<unsigned char>(a[i]), static_cast<unsigned char>(b[i]));
+                }
+                a += room;
+                b += room;
+                continue;
+            }
+            for (; room > 0; room--, a++, b++)
+            {
+                if (*a == '\0' || *a != *b)
+                    return CompareBytes(static_cast<unsigned char>(*a), static_cast<unsigned char>(*b));
+            }
+        }
+    }
+
+    // Swaps bytes within 16-bit words, then reverses the words
+    inline __m128i ReverseBytesSSE2(__m128i v)
+    {
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    }
+
+    // Reversed blocks trade places from both ends inward; what is left in the middle is reversed by the scalar loop
+    void ReverseSSE2(char* data, size_t length)
+    {
+        char* front = data;
+        char* back = data + length;
+        while (back - front >= 32)
+        {
+            back -= 16;
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(front));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(back));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(front), ReverseBytesSSE2(tail));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(back), ReverseBytesSSE2(head));
+            front += 16;
+        }
+        ReverseScalar(front, static_cast<size_t>(back - front));
+    }
+
+    // Bit i set where data[i] is not whitespace, for 64 bytes
+    inline unsigned long long NonSpaceMaskSSE2(const char* data)
+    {
+        unsigned long long spaces = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * k));
+            spaces |= static_cast<unsigned long long>(static_cast<unsigned>(_mm_movemask_epi8(SpaceMaskSSE2(v)))) << (16 * k);
+        }
+        return ~spaces;
+    }
+
+    inline unsigned long long ByteMaskSSE2(const char* data, char c)
+    {
+        const __m128i match = _mm_set1_epi8(c);
+        unsigned long long mask = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * k));
+            mask |= static_cast<unsigned long long>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, match)))) << (16 * k);
+        }
+        return mask;
+    }
+
+    // Word starts are the 0 -> 1 transitions of the non-space mask; bit 63 carries into the next block
+    // Bytes >= 0x80 are never whitespace, so no block needs the table
+    size_t CountWordsSSE2(const char* data, size_t length, bool* inWord)
+    {
+        unsigned long long carry = *inWord ? 1 : 0;
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 64 <= length; i += 64)
+        {
+            unsigned long long word = NonSpaceMaskSSE2(data + i);
+            count += PopCountPortable(word & ~((word << 1) | carry));
+            carry = word >> 63;
+        }
+        *inWord = carry != 0;
+        return count + CountWordsScalar(data + i, length - i, inWord);
+    }
+
+    size_t CountNonSpaceSSE2(const char* data, size_t length)
+    {
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 64 <= length; i += 64)
+            count += PopCountPortable(NonSpaceMaskSSE2(data + i));
+        return count + CountNonSpaceScalar(data + i, length - i);
+    }
+
+    size_t CountNewlinesSSE2(const char* data, size_t length)
+    {
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 64 <= length; i += 64)
+            count += PopCountPortable(ByteMaskSSE2(data + i, '\n'));
+        return count + CountNewlinesScalar(data + i, length - i);
+    }
+
+    // ============================================================================
+    // AVX2 kernels (32 bytes per step)
+    // ============================================================================
+
+    MYLIB_TARGET_AVX2 inline __m256i InRangeAVX2(__m256i v, char first, char last)
+    {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(first - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(last + 1)), v));
+    }
+
+    MYLIB_TARGET_AVX2 void ConvertAVX2(char* data, size_t length, char first, char last, const unsigned char* table)
+    {
+        const __m256i caseBit = _mm256_set1_epi8(0x20);
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            if (_mm256_movemask_epi8(v) != 0)
+            {
+                ConvertTable(data + i, 32, table);
+                continue;
+            }
+            __m256i flip = _mm256_and_si256(InRangeAVX2(v, first, last), caseBit);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_xor_si256(v, flip));
+        }
+        _mm256_zeroupper();
+        ConvertSSE2(data + i, length - i, first, last, table);
+    }
+
+    MYLIB_TARGET_AVX2 void ToUpperAVX2(char* data, size_t length)
+    {
+        ConvertAVX2(data, length, 'a', 'z', GetCaseTables().upper);
+    }
+
+    MYLIB_TARGET_AVX2 void ToLowerAVX2(char* data, size_t length)
+    {
+        ConvertAVX2(data, length, 'A', 'Z', GetCaseTables().lower);
+    }
+
+    MYLIB_TARGET_AVX2 bool CapitalizeAVX2(const char* input, char* output, size_t length, bool newWord)
+    {
+        if (length == 0)
+            return newWord;
+        newWord = CapitalizeScalar(input, output, 1, newWord);
+
+        const __m256i caseBit = _mm256_set1_epi8(0x20);
+        size_t i = 1;
+        for (; i + 32 <= length; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            if (_mm256_movemask_epi8(v) != 0)
+            {
+                CapitalizeScalar(input + i, output + i, 32, IsSpace(input[i - 1]));
+                continue;
+            }
+            __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i - 1));
+            __m256i afterSpace = _mm256_or_si256(_mm256_cmpeq_epi8(previous, _mm256_set1_epi8(' ')), InRangeAVX2(previous, '\t', '\r'));
+            __m256i flip = _mm256_or_si256(_mm256_and_si256(afterSpace, InRangeAVX2(v, 'a', 'z')),
+                                           _mm256_andnot_si256(afterSpace, InRangeAVX2(v, 'A', 'Z')));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_xor_si256(v, _mm256_and_si256(flip, caseBit)));
+        }
+        _mm256_zeroupper();
+        // The SSE2 kernel takes over at byte i, starting from the state after input[i - 1]
+        return CapitalizeSSE2(input + i, output + i, length - i, IsSpace(input[i - 1]));
+    }
+
+    MYLIB_TARGET_AVX2 inline unsigned ZeroMaskAVX2(const char* block)
+    {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+        return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+    }
+
+    // Same scheme as SSE2, then 64 aligned bytes per step; the byte-wise minimum is zero wherever either half has a NUL
+    MYLIB_TARGET_AVX2 TEXT_KERNEL_NO_ASAN size_t StringLengthAVX2(const char* str)
+    {
+        const uintptr_t skip = reinterpret_cast<uintptr_t>(str) & 31;
+        const char* block = str - skip;
+        unsigned mask = ZeroMaskAVX2(block) >> skip;
+        size_t length = 0;
+        if (mask != 0)
+        {
+            length = static_cast<size_t>(CountTrailingZeros(mask));
+        }
+        else
+        {
+            block += 32;
+            // One more single block when needed, so every pair below is 64-byte aligned and inside one page
+            if ((reinterpret_cast<uintptr_t>(block) & 32) != 0)
+            {
+                mask = ZeroMaskAVX2(block);
+                if (mask == 0)
+                    block += 32;
+            }
+            if (mask == 0)
+            {
+                const __m256i zero = _mm256_setzero_si256();
+                for (;; block += 64)
+                {
+                    __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+                    __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(block + 32));
+                    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(low, high), zero)) != 0)
+                        break;
+                }
+                mask = ZeroMaskAVX2(block);
+                if (mask == 0)
+                {
+                    block += 32;
+                    mask = ZeroMaskAVX2(block);
+                }
+            }
+            length = static_cast<size_t>(block - str) + CountTrailingZeros(mask);
+        }
+        _mm256_zeroupper();
+        return length;
+    }
+
+    // min(a, eq) is zero exactly where the bytes differ or a ends, so several blocks fold into one test
+    MYLIB_TARGET_AVX2 inline __m256i StopVectorAVX2(const char* a, const char* b)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        return _mm256_min_epu8(va, _mm256_cmpeq_epi8(va, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b))));
+    }
+
+    MYLIB_TARGET_AVX2 inline unsigned CompareMaskAVX2(const char* a, const char* b)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        return ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb))) |
+               static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, _mm256_setzero_si256())));
+    }
+
+    MYLIB_TARGET_AVX2 TEXT_KERNEL_NO_ASAN int CompareAVX2(const char* a, const char* b)
+    {
+        const char* start = a;
+        unsigned stop = 0;
+        for (;;)
+        {
+            size_t room = PageRoom(a, b);
+            for (; room >= 128; room -= 128, a += 128, b += 128)
+            {
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_min_epu8(StopVectorAVX2(a, b), StopVectorAVX2(a + 32, b + 32)),
+                                                                           _mm256_min_epu8(StopVectorAVX2(a + 64, b + 64), StopVectorAVX2(a + 96, b + 96))),
+                                                           _mm256_setzero_si256())) != 0)
+                    break;
+            }
+            for (; room >= 32; room -= 32, a += 32, b += 32)
+            {
+                stop = CompareMaskAVX2(a, b);
+                if (stop != 0)
+                    break;
+            }
+            if (stop != 0)
+                break;
+            if (room == 0)
+                continue;
+            const size_t back = 32 - room;
+            if (static_cast<size_t>(a - start) >= back)
+            {
+                stop = CompareMaskAVX2(a - back, b - back) >> back;
+                if (stop != 0)
+                    break;
+                a += room;
+                b += room;
+                continue;
+            }
+            for (; room > 0; room--, a++, b++)
+            {
+                if (*a == '\0' || *a != *b)
+                {
+                    _mm256_zeroupper();
+                    return CompareBytes(static_cast<unsigned char>(*a), static_cast<unsigned char>(*b));
+                }
+            }
+        }
+        _mm256_zeroupper();
+        int i = CountTrailingZeros(stop);
+        return CompareBytes(static_cast<unsigned char>(a[i]), static_cast<unsigned char>(b[i]));
+    }
+
+    // pshufb reverses each 16-byte lane, the lane swap finishes the 32-byte reverse
+    MYLIB_TARGET_AVX2 inline __m256i ReverseBytesAVX2(__m256i v)
+    {
+        const __m256i laneReverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                                     15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+        return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, laneReverse), _MM_SHUFFLE(1, 0, 3, 2));
+    }
+
+    MYLIB_TARGET_AVX2 void ReverseAVX2(char* data, size_t length)
+    {
+        char* front = data;
+        char* back = data + length;
+        while (back - front >= 64)
+        {
+            back -= 32;
+            __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(front));
+            __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(back));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(front), ReverseBytesAVX2(tail));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(back), ReverseBytesAVX2(head));
+            front += 32;
+        }
+        _mm256_zeroupper();
+        ReverseSSE2(front, static_cast<size_t>(back - front));
+    }
+
+    MYLIB_TARGET_AVX2 inline size_t PopCountAVX2(unsigned long long x)
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return static_cast<size_t>(_mm_popcnt_u64(x));
+#else
+        return static_cast<size_t>(_mm_popcnt_u32(static_cast<unsigned>(x)) + _mm_popcnt_u32(static_cast<unsigned>(x >> 32)));
+#endif
+    }
+
+    MYLIB_TARGET_AVX2 inline unsigned long long Combine64AVX2(__m256i low, __m256i high)
+    {
+        return static_cast<unsigned long long>(static_cast<unsigned>(_mm256_movemask_epi8(low))) |
+               (static_cast<unsigned long long>(static_cast<unsigned>(_mm256_movemask_epi8(high))) << 32);
+    }
+
+    MYLIB_TARGET_AVX2 inline __m256i SpaceMaskAVX2(__m256i v)
+    {
+        return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), InRangeAVX2(v, '\t', '\r'));
+    }
+
+    // Same transitions as SSE2, with two 32-byte class masks per 64-bit word and hardware popcount
+    MYLIB_TARGET_AVX2 size_t CountWordsAVX2(const char* data, size_t length, bool* inWord)
+    {
+        unsigned long long carry = *inWord ? 1 : 0;
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 64 <= length; i += 64)
+        {
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+            unsigned long long word = ~Combine64AVX2(SpaceMaskAVX2(low), SpaceMaskAVX2(high));
+            count += PopCountAVX2(word & ~((word << 1) | carry));
+            carry = word >> 63;
+        }
+        _mm256_zeroupper();
+        *inWord = carry != 0;
+        return count + CountWordsScalar(data + i, length - i, inWord);
+    }
+
+    MYLIB_TARGET_AVX2 size_t CountNonSpaceAVX2(const char* data, size_t length)
+    {
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 64 <= length; i += 64)
+        {
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+            count += 64 - PopCountAVX2(Combine64AVX2(SpaceMaskAVX2(low), SpaceMaskAVX2(high)));
+        }
+        _mm256_zeroupper();
+        return count + CountNonSpaceScalar(data + i, length - i);
+    }
+
+    MYLIB_TARGET_AVX2 size_t CountNewlinesAVX2(const char* data, size_t length)
+    {
+        const __m256i newline = _mm256_set1_epi8('\n');
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + 64 <= length; i += 64)
+        {
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+            count += PopCountAVX2(Combine64AVX2(_mm256_cmpeq_epi8(low, newline), _mm256_cmpeq_epi8(high, newline)));
+        }
+        _mm256_zeroupper();
+        return count + CountNewlinesScalar(data + i, length - i);
+    }
+#endif
+
+    // ============================================================================
+    // Runtime dispatch
+    // ============================================================================
+
+    typedef void (*ConvertKernel)(char*, size_t);
+    typedef bool (*CapitalizeKernel)(const char*, char*, size_t, bool);
+    typedef size_t (*LengthKernel)(const char*);
+    typedef int (*CompareKernel)(const char*, const char*);
+    typedef size_t (*CountWordsKernel)(const char*, size_t, bool*);
+    typedef size_t (*CountBytesKernel)(const char*, size_t);
+
+    struct TextKernelTable
+    {
+        SimdLevel level;
+        ConvertKernel toUpper;
+        ConvertKernel toLower;
+        CapitalizeKernel capitalize;
+        LengthKernel stringLength;
+        CompareKernel compare;
+        ConvertKernel reverse;
+        CountWordsKernel countWords;
+        CountBytesKernel countNewlines;
+        CountBytesKernel countNonSpace;
+    };
+
+    TextKernelTable SelectTextKernels()
+    {
+        TextKernelTable kernels = { SimdLevel::Scalar, ToUpperScalar, ToLowerScalar, CapitalizeScalar,
+                                     StringLengthScalar, CompareScalar, ReverseScalar,
+                                     CountWordsScalar, CountNewlinesScalar, CountNonSpaceScalar };
+#ifdef MYLIB_X86
+        switch (GetSimdLevel())
+        {
+        case SimdLevel::AVX2:
+            kernels = { SimdLevel::AVX2, ToUpperAVX2, ToLowerAVX2, CapitalizeAVX2,
+                        StringLengthAVX2, CompareAVX2, ReverseAVX2,
+                        CountWordsAVX2, CountNewlinesAVX2, CountNonSpaceAVX2 };
+            break;
+        case SimdLevel::SSE2:
+            kernels = { SimdLevel::SSE2, ToUpperSSE2, ToLowerSSE2, CapitalizeSSE2,
+                        StringLengthSSE2, CompareSSE2, ReverseSSE2,
+                        CountWordsSSE2, CountNewlinesSSE2, CountNonSpaceSSE2 };
+            break;
+        default:
+            break;
+        }
+#endif
+        return kernels;
+    }
+
+    const TextKernelTable& GetTextKernels()
+    {
+        static const TextKernelTable kernels = SelectTextKernels();
+        return kernels;
+    }
+}
+
+// ============================================================================
+// TextKernels entry points
+// ============================================================================
+
+namespace TextKernels
+{
+    SimdLevel GetLevel()
+    {
+        return GetTextKernels().level;
+    }
+
+    void ToUpper(char* data, size_t length)
+    {
+        GetTextKernels().toUpper(data, length);
+    }
+
+    void ToLower(char* data, size_t length)
+    {
+        GetTextKernels().toLower(data, length);
+    }
+
+    bool CapitalizeWords(const char* input, char* output, size_t length, bool newWord)
+    {
+        return GetTextKernels().capitalize(input, output, length, newWord);
+    }
+
+    size_t StringLength(const char* str)
+    {
+        return GetTextKernels().stringLength(str);
+    }
+
+    int Compare(const char* a, const char* b)
+    {
+        return GetTextKernels().compare(a, b);
+    }
+
+    void Reverse(char* data, size_t length)
+    {
+        GetTextKernels().reverse(data, length);
+    }
+
+    size_t CountWords(const char* data, size_t length, bool* inWord)
+    {
+        return GetTextKernels().countWords(data, length, inWord);
+    }
+
+    size_t CountNewlines(const char* data, size_t length)
+    {
+        return GetTextKernels().countNewlines(data, length);
+    }
+
+    size_t CountNonWhitespace(const char* data, size_t length)
+    {
+        return GetTextKernels().countNonSpace(data, length);
+    }
+
+    bool IsWhitespace(char c)
+    {
+        return IsSpace(c);
+    }
+
+    bool IsTrimmedWhitespace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    std::string_view Trim(std::string_view input)
+    {
+        const char* const trimmed = " \t\n\r";
+        size_t start = input.find_first_not_of(trimmed);
+        if (start == std::string_view::npos)
+            return input;
+        size_t end = input.find_last_not_of(trimmed);
+        return input.substr(start, end + 1 - start);
+    }
+
+    // Branch-free: every byte is stored and the output position only advances past kept bytes
+    // Trailing whitespace is cut off first, so no store lands past the returned length
+    size_t RemoveWhitespace(const char* input, char* output, size_t length)
+    {
+        const bool* space = GetCaseTables().space;
+        while (length > 0 && space[static_cast<unsigned char>(input[length - 1])])
+            length--;
+        size_t kept = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            char c = input[i];
+            output[kept] = c;
+            kept += space[static_cast<unsigned char>(c)] ? 0 : 1;
+        }
+        return kept;
+    }
+}
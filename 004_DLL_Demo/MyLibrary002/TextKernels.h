@@ -0,0 +1,53 @@
+//*******************************************************************************************************************
+//**  TextKernels.h - SIMD Text Kernels for MyLibrary002 (internal header)
+//**  AVX2/SSE2/table kernels behind StringUtility and TextProcessor, selected once at runtime from CPUID
+//**  Character classes follow the C locale: only A-Z/a-z change case, whitespace is 0x09-0x0D and 0x20
+//********************************************************************************************************************
+
+#pragma once
+#ifndef TEXTKERNELS_H
+#define TEXTKERNELS_H
+
+#include <cstddef>
+#include <string_view>
+#include "../Common/CpuFeatures.h"
+
+namespace TextKernels
+{
+    SimdLevel GetLevel();
+
+    // In place
+    void ToUpper(char* data, size_t length);
+    void ToLower(char* data, size_t length);
+
+    // Uppercases the first letter of every word and lowercases the rest; input and output may be the same buffer
+    // newWord is true when the byte before input was whitespace (or there was none); returns the state after the last byte
+    bool CapitalizeWords(const char* input, char* output, size_t length, bool newWord);
+
+    // NUL-terminated strings; no load crosses into a page the string does not reach
+    size_t StringLength(const char* str);
+    int Compare(const char* a, const char* b);  // -1, 0 or 1, bytes ordered as unsigned
+
+    // In place
+    void Reverse(char* data, size_t length);
+
+    // Number of words starting in data; *inWord is true when the byte before data was not whitespace,
+    // and is updated to the state after the last byte so counts can continue across buffers
+    size_t CountWords(const char* data, size_t length, bool* inWord);
+    size_t CountNewlines(const char* data, size_t length);
+
+    // Bytes RemoveWhitespace keeps, i.e. its result length
+    size_t CountNonWhitespace(const char* data, size_t length);
+    bool IsWhitespace(char c);
+
+    // Copies the non-whitespace bytes of input to output (which may be input) and returns how many were kept
+    // Nothing is written past output + the returned count
+    size_t RemoveWhitespace(const char* input, char* output, size_t length);
+
+    // TextProcessor::ProcessText's trim, shared by every path that must match it: only ' ', '\t', '\n' and '\r' are
+    // trimmed (not the full whitespace class above), and all-whitespace input is returned unchanged
+    bool IsTrimmedWhitespace(char c);
+    std::string_view Trim(std::string_view input);
+}
+
+#endif // TEXTKERNELS_H
@@ -0,0 +1,190 @@
+//*******************************************************************************************************************
+//**  TextPipeline.cpp - Fused TextProcessor Stage Pipelines
+//**  Stages are simplified into a cached plan that runs every step on one cache-sized block before the next block
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "MyLibrary002.h"
+#include "StringInstrumentation.h"
+#include "TextKernels.h"
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // Blocks stay in L1 between steps, so each step after the first works on cached bytes
+    const size_t kBlockSize = 16 * 1024;
+
+    enum PipelineStage
+    {
+        STAGE_PROCESS_TEXT,
+        STAGE_REMOVE_WHITESPACE,
+        STAGE_CAPITALIZE_WORDS
+    };
+}
+
+struct TextPipeline::Plan
+{
+    std::vector<PipelineStage> stages;
+
+    // Compiled form: an optional trim of the whole input (a slice, no copy), then per-block steps
+    bool compiled;
+    bool trim;
+    std::vector<PipelineStage> steps;
+
+    Plan() : compiled(false), trim(false)
+    {
+    }
+
+    void Add(PipelineStage stage)
+    {
+        stages.push_back(stage);
+        compiled = false;
+    }
+
+    // Rewrite rules, each keeping the output of the original chain:
+    // - RemoveWhitespace leaves no whitespace and no later stage adds any, so a second one is a no-op
+    // - A trim before RemoveWhitespace only removes bytes it removes too (all-whitespace input ends up empty
+    //   either way), a trim after it has nothing to do, and a trim commutes with CapitalizeWords, so trims
+    //   move to the front or disappear
+    // - CapitalizeWords sets the case of every letter from the whitespace around it, which only
+    //   RemoveWhitespace changes and which no stage reads, so the last CapitalizeWords overrides earlier ones
+    void Compile()
+    {
+        trim = false;
+        steps.clear();
+        bool removesWhitespace = false;
+        for (PipelineStage stage : stages)
+        {
+            switch (stage)
+            {
+            case STAGE_PROCESS_TEXT:
+                trim = true;
+                break;
+            case STAGE_REMOVE_WHITESPACE:
+                if (!removesWhitespace)
+                    steps.push_back(STAGE_REMOVE_WHITESPACE);
+                removesWhitespace = true;
+                break;
+            case STAGE_CAPITALIZE_WORDS:
+                for (size_t i = 0; i < steps.size(); i++)
+                {
+                    if (steps[i] == STAGE_CAPITALIZE_WORDS)
+                        steps.erase(steps.begin() + static_cast<std::ptrdiff_t>(i--));
+                }
+                steps.push_back(STAGE_CAPITALIZE_WORDS);
+                break;
+            }
+        }
+        if (removesWhitespace)
+            trim = false;
+        compiled = true;
+    }
+};
+
+// ============================================================================
+// TextPipeline class implementation
+// ============================================================================
+
+TextPipeline::TextPipeline() : m_plan(new Plan())
+{
+}
+
+TextPipeline::~TextPipeline()
+{
+    delete m_plan;
+}
+
+TextPipeline& TextPipeline::ProcessText()
+{
+    m_plan->Add(STAGE_PROCESS_TEXT);
+    return *this;
+}
+
+TextPipeline& TextPipeline::RemoveWhitespace()
+{
+    m_plan->Add(STAGE_REMOVE_WHITESPACE);
+    return *this;
+}
+
+TextPipeline& TextPipeline::CapitalizeWords()
+{
+    m_plan->Add(STAGE_CAPITALIZE_WORDS);
+    return *this;
+}
+
+void TextPipeline::Clear()
+{
+    m_plan->stages.clear();
+    m_plan->compiled = false;
+}
+
+int TextPipeline::GetStageCount() const
+{
+    return static_cast<int>(m_plan->stages.size());
+}
+
+int TextPipeline::GetPlanStepCount()
+{
+    if (!m_plan->compiled)
+        m_plan->Compile();
+    return static_cast<int>(m_plan->steps.size()) + (m_plan->trim ? 1 : 0);
+}
+
+void TextPipeline::Run(std::string_view input, std::string& output, TextPipelineStatistics* stats)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_PIPELINE_RUN);
+    if (!m_plan->compiled)
+        m_plan->Compile();
+    const std::vector<PipelineStage>& steps = m_plan->steps;
+    if (m_plan->trim)
+        input = TextKernels::Trim(input);
+
+    // The first step reads the input block and writes the output tail; later steps work in place on that tail.
+    // CapitalizeWords steps and the statistics carry their word state from one block to the next
+    output.clear();
+    output.reserve(input.length());
+    std::vector<bool> newWord(steps.size(), true);
+    bool inWord = false;
+    unsigned long long words = 0;
+    unsigned long long newlines = 0;
+    for (size_t offset = 0; offset < input.length(); offset += kBlockSize)
+    {
+        size_t length = (input.length() - offset < kBlockSize) ? input.length() - offset : kBlockSize;
+        const size_t start = output.size();
+        output.resize(start + length);
+        char* block = &output[start];
+        const char* source = input.data() + offset;
+        if (steps.empty())
+            memcpy(block, source, length);
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            if (steps[i] == STAGE_REMOVE_WHITESPACE)
+                length = TextKernels::RemoveWhitespace(source, block, length);
+            else
+                newWord[i] = TextKernels::CapitalizeWords(source, block, length, newWord[i]);
+            source = block;
+        }
+        output.resize(start + length);
+
+        if (stats != nullptr)
+        {
+            words += TextKernels::CountWords(block, length, &inWord);
+            newlines += TextKernels::CountNewlines(block, length);
+        }
+    }
+
+    if (stats != nullptr)
+    {
+        stats->outputBytes = static_cast<long long>(output.size());
+        stats->words = static_cast<long long>(words);
+        stats->lines = output.empty() ? 0 : static_cast<long long>(newlines + 1);
+    }
+}
+
+std::string TextPipeline::Run(std::string_view input)
+{
+    std::string output;
+    Run(input, output);
+    return output;
+}
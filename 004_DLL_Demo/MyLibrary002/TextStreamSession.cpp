@@ -0,0 +1,85 @@
+//*******************************************************************************************************************
+//**  TextStreamSession.cpp - Incremental Streaming TextProcessor
+//**  Carries the word state of the last byte across fragments and runs the TextKernels on each fragment as it arrives
+//********************************************************************************************************************
+
+#include "pch.h"
+#include "MyLibrary002.h"
+#include "StringInstrumentation.h"
+#include "TextKernels.h"
+
+// ============================================================================
+// TextStreamSession class implementation
+// ============================================================================
+
+TextStreamSession::TextStreamSession(TextStreamTransform transform)
+    : m_transform(transform), m_inWord(false), m_bytes(0), m_words(0), m_newlines(0),
+      m_output(nullptr), m_outputCapacity(0)
+{
+}
+
+TextStreamSession::~TextStreamSession()
+{
+    delete[] m_output;
+}
+
+std::string_view TextStreamSession::Feed(const char* data, size_t length)
+{
+    MYLIBRARY002_INSTRUMENT(INSTRUMENTED_TEXT_STREAM_FEED);
+    if (data == nullptr || length == 0)
+        return std::string_view();
+
+    // The fragment's words are counted before m_inWord moves on to its last byte;
+    // capitalization starts a word exactly where counting does, so both use the state before the fragment
+    const bool newWord = !m_inWord;
+    m_words += TextKernels::CountWords(data, length, &m_inWord);
+    m_newlines += TextKernels::CountNewlines(data, length);
+    m_bytes += length;
+
+    if (m_transform == TEXT_STREAM_COUNT_ONLY)
+        return std::string_view();
+
+    // No transform makes a fragment longer, so the buffer only grows to the largest fragment; old contents are not kept
+    if (length > m_outputCapacity)
+    {
+        delete[] m_output;
+        m_output = new char[length];
+        m_outputCapacity = length;
+    }
+
+    size_t written = length;
+    if (m_transform == TEXT_STREAM_CAPITALIZE_WORDS)
+        TextKernels::CapitalizeWords(data, m_output, length, newWord);
+    else
+        written = TextKernels::RemoveWhitespace(data, m_output, length);
+    return std::string_view(m_output, written);
+}
+
+void TextStreamSession::Finish(TextStreamStatistics* stats)
+{
+    if (stats != nullptr)
+    {
+        stats->bytes = static_cast<long long>(m_bytes);
+        stats->words = static_cast<long long>(m_words);
+        stats->lines = (m_bytes == 0) ? 0 : static_cast<long long>(m_newlines + 1);
+    }
+    Reset();
+}
+
+void TextStreamSession::Reset()
+{
+    m_inWord = false;
+    m_bytes = 0;
+    m_words = 0;
+    m_newlines = 0;
+}
+
+TextStreamTransform TextStreamSession::GetTransform() const
+{
+    return m_transform;
+}
+
+long long TextStreamSession::GetBytesFed() const
+{
+    return static_cast<long long>(m_bytes);
+}